@@ -0,0 +1,274 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// umoria_bench: micro-benchmarks for the engine hot paths, with fixed seeds
+//
+// Run it from the build `umoria` directory, so the data files can be found.
+
+#include "headers.h"
+#include <new>
+
+constexpr uint32_t BENCH_SEED = 12345;
+
+// Human warrior named "Bench", with the first rolled stats.
+static const char *bench_character_keys = " am\033aBench\r ";
+
+static const char *bench_save_file = "umoria_bench.sav";
+
+//
+// Every allocation in the process is counted, so each benchmark can report allocations per op.
+//
+
+static std::atomic<uint64_t> allocations_counter{0};
+
+void *operator new(size_t size) {
+    allocations_counter++;
+
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void *memory, size_t size) noexcept {
+    (void) size;
+    free(memory);
+}
+
+// Times `iterations` calls of `run(i)`, then prints the ns/op and allocations/op.
+template <typename Function>
+static void benchRun(const char *name, int iterations, Function run) {
+    uint64_t allocations = allocations_counter;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; i++) {
+        run(i);
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    allocations = allocations_counter - allocations;
+
+    printf("%-36s %10d %14.1f ns/op %10.2f allocs/op\n", name, iterations, elapsed.count() / iterations, (double) allocations / iterations);
+    (void) fflush(stdout);
+}
+
+// xorshift32, kept apart from the game RNG so the benchmark inputs never change.
+static uint32_t benchRandom(uint32_t &state, uint32_t max) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state % max;
+}
+
+static void benchGenerateLevel(int level, uint32_t seed) {
+    dg.current_level = (int16_t) level;
+    setRandomSeed(seed);
+    generateCave();
+}
+
+static void benchGenerateCave() {
+    benchRun("generateCave (town)", 200, [](int i) {
+        benchGenerateLevel(0, BENCH_SEED + (uint32_t) i);
+    });
+
+    for (int first = 1; first <= 50; first += 10) {
+        char name[40];
+        (void) snprintf(name, sizeof(name), "generateCave (depths %d-%d)", first, first + 9);
+
+        benchRun(name, 200, [first](int i) {
+            benchGenerateLevel(first + i % 10, BENCH_SEED + (uint32_t) i);
+        });
+    }
+}
+
+static void benchUpdateMonsters() {
+    // Level 30 with a few extra monsters
+    benchGenerateLevel(30, BENCH_SEED);
+    monsterPlaceNewWithinDistance(40, 0, false);
+
+    char name[40];
+    (void) snprintf(name, sizeof(name), "updateMonsters(true) (%d monsters)", (int) monster_pool.used);
+
+    benchRun(name, 2000, [](int) {
+        // Keep the player alive, and in place
+        py.misc.current_hp = py.misc.max_hp;
+        game.character_is_dead = false;
+
+        updateMonsters(true);
+        dg.game_turn++;
+    });
+}
+
+static void benchLos() {
+    benchGenerateLevel(10, BENCH_SEED);
+
+    // Pairs of points within monster sight range of each other.
+    constexpr int pairs = 4096;
+    std::vector<Coord_t> from(pairs);
+    std::vector<Coord_t> to(pairs);
+
+    uint32_t state = BENCH_SEED;
+    for (int i = 0; i < pairs; i++) {
+        from[i] = Coord_t{(int) benchRandom(state, (uint32_t) dg.height), (int) benchRandom(state, (uint32_t) dg.width)};
+        do {
+            to[i] = Coord_t{from[i].y + (int) benchRandom(state, 41) - 20, from[i].x + (int) benchRandom(state, 41) - 20};
+        } while (!coordInBounds(to[i]));
+    }
+
+    int visible = 0;
+    benchRun("los (random pairs)", 1000000, [&](int i) {
+        visible += los(from[i % pairs], to[i % pairs]) ? 1 : 0;
+    });
+    (void) visible;
+}
+
+static void benchDrawDungeonPanel() {
+    benchGenerateLevel(10, BENCH_SEED);
+    dungeonResetView();
+
+    benchRun("drawDungeonPanel", 20000, [](int) {
+        drawDungeonPanel();
+        putQIO();
+    });
+}
+
+static void benchSaveLoad() {
+    benchGenerateLevel(10, BENCH_SEED);
+
+    config::files::save_game = bench_save_file;
+
+    benchRun("saveGame + loadGame", 200, [](int) {
+        (void) unlink(bench_save_file);
+
+        game.character_saved = false;
+        (void) saveGame();
+
+        bool generate;
+        (void) loadGame(generate);
+    });
+
+    (void) unlink(bench_save_file);
+}
+
+static void benchRandomNumbers() {
+    setRandomSeed(BENCH_SEED);
+
+    // Summed so the results are used
+    int sum = 0;
+
+    benchRun("randomNumber(100)", 10000000, [&](int i) {
+        sum += randomNumber(100 + (i & 1));
+    });
+
+    int32_t values[256];
+    benchRun("randomNumbers(100) x256", 100000, [&](int i) {
+        randomNumbers(100 + (i & 1), values, 256);
+        sum += values[i & 255];
+    });
+
+    benchRun("randomNumberNormalDistribution(100, 10)", 1000000, [&](int) {
+        sum += randomNumberNormalDistribution(100, 10);
+    });
+
+    benchRun("diceRoll(2d6)", 1000000, [&](int) {
+        sum += diceRoll(Dice_t{2, 6});
+    });
+
+    for (auto fast : {false, true}) {
+        config::options::fast_dice_rolls = fast;
+
+        benchRun(fast ? "diceRoll(8d6), fast" : "diceRoll(8d6)", 1000000, [&](int) {
+            sum += diceRoll(Dice_t{8, 6});
+        });
+
+        benchRun(fast ? "diceRoll(30d10), fast" : "diceRoll(30d10)", 1000000, [&](int) {
+            sum += diceRoll(Dice_t{30, 10});
+        });
+
+        benchRun(fast ? "diceRoll(105d8), fast" : "diceRoll(105d8)", 1000000, [&](int) {
+            sum += diceRoll(Dice_t{105, 8});
+        });
+    }
+    config::options::fast_dice_rolls = false;
+
+    if (sum == 0) {
+        printf("(no random numbers)\n");
+    }
+}
+
+static void benchItems() {
+    setRandomSeed(BENCH_SEED);
+
+    int treasure_id = popt();
+    Inventory_t &item = game.treasure.list[treasure_id];
+
+    std::vector<Inventory_t> items(1000);
+
+    benchRun("magicTreasureMagicalAbility (+copy)", 100000, [&](int i) {
+        inventoryItemCopyTo(i % MAX_DUNGEON_OBJECTS, item);
+        magicTreasureMagicalAbility(treasure_id, 30);
+
+        items[i % items.size()] = item;
+    });
+
+    obj_desc_t description = {'\0'};
+    benchRun("itemDescription", 100000, [&](int i) {
+        itemDescription(description, items[i % items.size()], true);
+    });
+
+    pusht((uint8_t) treasure_id);
+}
+
+static thread_local bool bench_running = false;
+static thread_local bool bench_done = false;
+
+// Key queue refill: the first time the game asks for a command, the
+// character is standing in town, and the game is fully set up.
+static void benchQueueKeys() {
+    if (bench_done) {
+        // No more keys, which ends the game.
+        return;
+    }
+    if (bench_running) {
+        // Dismiss any -more- prompts from the game while benchmarking.
+        inputQueueKeys(std::string(1, ESCAPE));
+        return;
+    }
+    bench_running = true;
+
+    printf("%-36s %10s %20s %20s\n", "benchmark", "iterations", "time", "allocations");
+
+    benchGenerateCave();
+    benchUpdateMonsters();
+    benchLos();
+    benchDrawDungeonPanel();
+    benchSaveLoad();
+    benchRandomNumbers();
+    benchItems();
+
+    bench_done = true;
+}
+
+int main() {
+    rendererSelect(Renderer::Framebuffer);
+    (void) terminalInitialize();
+
+    inputSelectQueue(benchQueueKeys);
+    inputQueueKeys(bench_character_keys);
+
+    startMoria(BENCH_SEED, true, false);
+
+    if (!bench_done) {
+        std::cerr << "The benchmarks did not run, check the data files are in ./data\n";
+        return 1;
+    }
+
+    return 0;
+}
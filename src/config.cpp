@@ -21,22 +21,27 @@ namespace config {
         const std::string death_tomb = "data/death_tomb.txt";
         const std::string death_royal = "data/death_royal.txt";
         const std::string scores = "scores.dat";
-        std::string save_game = "game.sav";
+        thread_local std::string save_game = "game.sav";
+        thread_local bool save_game_backup = false; // Keep the previous save as `save_game` + ".bak"
+        thread_local int autosave_turns = 0;         // Autosave every this many turns and on new levels, 0 for never
     } // namespace files
 
     // Game options as set on startup and with `=` set options command -CJS-
     namespace options {
-        bool display_counts = true;          // Display rest/repeat counts
-        bool find_bound = false;             // Print yourself on a run (slower)
-        bool run_cut_corners = true;         // Cut corners while running
-        bool run_examine_corners = true;     // Check corners while running
-        bool run_ignore_doors = false;       // Run through open doors
-        bool run_print_self = false;         // Stop running when the map shifts
-        bool highlight_seams = false;        // Highlight magma and quartz veins
-        bool prompt_to_pickup = false;       // Prompt to pick something up
-        bool use_roguelike_keys = false;     // Use classic Roguelike keys
-        bool show_inventory_weights = false; // Display weights in inventory
-        bool error_beep_sound = true;        // Beep for invalid characters
+        thread_local bool display_counts = true;          // Display rest/repeat counts
+        thread_local bool find_bound = false;             // Print yourself on a run (slower)
+        thread_local bool run_cut_corners = true;         // Cut corners while running
+        thread_local bool run_examine_corners = true;     // Check corners while running
+        thread_local bool run_ignore_doors = false;       // Run through open doors
+        thread_local bool run_print_self = false;         // Stop running when the map shifts
+        thread_local bool highlight_seams = false;        // Highlight magma and quartz veins
+        thread_local bool prompt_to_pickup = false;       // Prompt to pick something up
+        thread_local bool use_roguelike_keys = false;     // Use classic Roguelike keys
+        thread_local bool show_inventory_weights = false; // Display weights in inventory
+        thread_local bool error_beep_sound = true;        // Beep for invalid characters
+        thread_local bool fast_forward = false;           // Rest/repeat/run without delays or screen updates
+        thread_local bool monster_pathing = false;        // Monsters chase the player around walls
+        thread_local bool fast_dice_rolls = false;        // Roll many dice with one random number, see diceRoll()
     } // namespace options
 
     // Dungeon generation values
@@ -167,6 +172,7 @@ namespace config {
         const uint8_t MON_SUMMONED_LEVEL_ADJUST = 2;      // Adjust level of summoned creatures
         const uint8_t MON_PLAYER_EXP_DRAINED_PER_HIT = 2; // Percent of player exp drained per hit
         const uint8_t MON_MIN_INDEX_ID = 2;               // Minimum index in m_list (1 = py, 0 = no mon)
+        const uint8_t MON_FLOW_DISTANCE = 20;             // Maximum dis a creature follows a path around walls
         const uint8_t SCARE_MONSTER = 99;
 
         // definitions for creatures, cmove field
@@ -20,21 +20,26 @@ namespace config {
         extern const std::string death_tomb;
         extern const std::string death_royal;
         extern const std::string scores;
-        extern std::string save_game;
+        extern thread_local std::string save_game;
+        extern thread_local bool save_game_backup;
+        extern thread_local int autosave_turns;
     }
 
     namespace options {
-        extern bool display_counts;
-        extern bool find_bound;
-        extern bool run_cut_corners;
-        extern bool run_examine_corners;
-        extern bool run_ignore_doors;
-        extern bool run_print_self;
-        extern bool highlight_seams;
-        extern bool prompt_to_pickup;
-        extern bool use_roguelike_keys;
-        extern bool show_inventory_weights;
-        extern bool error_beep_sound;
+        extern thread_local bool display_counts;
+        extern thread_local bool find_bound;
+        extern thread_local bool run_cut_corners;
+        extern thread_local bool run_examine_corners;
+        extern thread_local bool run_ignore_doors;
+        extern thread_local bool run_print_self;
+        extern thread_local bool highlight_seams;
+        extern thread_local bool prompt_to_pickup;
+        extern thread_local bool use_roguelike_keys;
+        extern thread_local bool show_inventory_weights;
+        extern thread_local bool error_beep_sound;
+        extern thread_local bool fast_forward;
+        extern thread_local bool monster_pathing;
+        extern thread_local bool fast_dice_rolls;
     }
 
     namespace dungeon {
@@ -157,6 +162,7 @@ namespace config {
         extern const uint8_t MON_SUMMONED_LEVEL_ADJUST;
         extern const uint8_t MON_PLAYER_EXP_DRAINED_PER_HIT;
         extern const uint8_t MON_MIN_INDEX_ID;
+        extern const uint8_t MON_FLOW_DISTANCE;
         extern const uint8_t SCARE_MONSTER;
 
         namespace move {
@@ -90,7 +90,7 @@ uint8_t blows_table[7][6] = {
 // this table is used to generate a pseudo-normal distribution.  See
 // the function randomNumberNormalDistribution() in misc1.c, this is much faster than calling
 // transcendental function to calculate a true normal distribution.
-uint16_t normal_table[NORMAL_TABLE_SIZE] = {
+static constexpr uint16_t normal_table[NORMAL_TABLE_SIZE] = {
     206,     613,    1022,    1430,    1838,    2245,    2652,    3058,
     3463,    3867,    4271,    4673,    5075,    5475,    5874,    6271,
     6667,    7061,    7454,    7845,    8234,    8621,    9006,    9389,
@@ -124,3 +124,50 @@ uint16_t normal_table[NORMAL_TABLE_SIZE] = {
     32763,   32763,   32763,   32764,   32764,   32764,   32764,   32765,
     32765,   32765,   32765,   32766,   32766,   32766,   32766,   32766,
 };
+
+// The index the original binary search of normal_table found for `value`.
+// It stops on the first entry equal to `value` it lands on, so it is only
+// used for the values the table repeats; see normalTableInverse().
+static constexpr int normalTableSearch(int value) {
+    int low = 0;
+    int iindex = NORMAL_TABLE_SIZE >> 1;
+    int high = NORMAL_TABLE_SIZE;
+
+    while (normal_table[iindex] != value && high != low + 1) {
+        if (normal_table[iindex] > value) {
+            high = iindex;
+            iindex = low + ((iindex - low) >> 1);
+        } else {
+            low = iindex;
+            iindex = iindex + ((high - iindex) >> 1);
+        }
+    }
+
+    // might end up one below target, check that here
+    if (normal_table[iindex] < value) {
+        iindex = iindex + 1;
+    }
+
+    return iindex;
+}
+
+// Builds normal_table_inverse with one walk up normal_table: every value gets
+// the first entry not below it, as the binary search would, except where the
+// search lands on a later copy of a repeated entry.
+static constexpr NormalTableInverse_t normalTableInverse() {
+    NormalTableInverse_t inverse{};
+
+    int iindex = 0;
+    for (int value = 1; value < SHRT_MAX; value++) {
+        while (normal_table[iindex] < value) {
+            iindex++;
+        }
+
+        bool repeated = iindex + 1 < NORMAL_TABLE_SIZE && normal_table[iindex + 1] == value;
+        inverse.index[value] = (uint8_t) (repeated ? normalTableSearch(value) : iindex);
+    }
+
+    return inverse;
+}
+
+constexpr NormalTableInverse_t normal_table_inverse = normalTableInverse();
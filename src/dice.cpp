@@ -5,11 +5,112 @@
 
 #include "headers.h"
 
+// Number of values rngNext() returns: 1 to 2^31 - 2.
+constexpr uint32_t DICE_RNG_VALUES = 0x7FFFFFFEUL;
+
+// The distribution of the totals of some dice. Entry `k` of `totals` is the
+// chance of rolling at most `dice + k`, as a count of the DICE_RNG_VALUES
+// values rngNext() returns. `guide` splits those values into equal ranges by
+// their top `guide_bits` bits, and holds the first total of each range.
+typedef struct {
+    std::vector<uint32_t> totals{};
+    std::vector<uint32_t> guide{};
+    int guide_bits = 0;
+} DiceDistribution_t;
+
+// The distributions of the large dice rolled so far, by dice << 8 | sides.
+static thread_local std::unordered_map<uint16_t, DiceDistribution_t> dice_distributions;
+
+// Works out the chance of every total of `dice`, one die at a time: the
+// chance of each total with one more die is the mean of the chances of the
+// `sides` totals it can be reached from.
+static DiceDistribution_t diceDistribution(Dice_t const &dice) {
+    int totals = dice.dice * (dice.sides - 1) + 1;
+
+    std::vector<double> chances(totals, 0.0);
+    std::vector<double> next(totals, 0.0);
+    chances[0] = 1.0;
+
+    for (auto die = 1; die < dice.dice + 1; die++) {
+        double window = 0.0;
+        int last = (die - 1) * (dice.sides - 1);
+
+        for (auto k = 0; k < die * (dice.sides - 1) + 1; k++) {
+            if (k <= last) {
+                window += chances[k];
+            }
+            if (k >= dice.sides) {
+                window -= chances[k - dice.sides];
+            }
+            next[k] = window / dice.sides;
+        }
+        chances.swap(next);
+    }
+
+    DiceDistribution_t distribution{std::vector<uint32_t>(totals), {}, 0};
+
+    double chance = 0.0;
+    for (auto k = 0; k < totals; k++) {
+        chance += chances[k];
+        distribution.totals[k] = (uint32_t) std::min((double) DICE_RNG_VALUES, chance * DICE_RNG_VALUES + 0.5);
+    }
+    distribution.totals[totals - 1] = DICE_RNG_VALUES;
+
+    // At least as many ranges as totals, so a lookup scans a total or two
+    while ((1 << distribution.guide_bits) < totals) {
+        distribution.guide_bits++;
+    }
+    distribution.guide.resize(1u << distribution.guide_bits);
+
+    uint32_t total = 0;
+    for (auto range = 0u; range < distribution.guide.size(); range++) {
+        uint32_t first_value = range << (31 - distribution.guide_bits);
+        while (distribution.totals[total] <= first_value) {
+            total++;
+        }
+        distribution.guide[range] = total;
+    }
+
+    return distribution;
+}
+
+// Rolls all the dice with one random number, looked up in the distribution
+// of their totals. Totals less likely than one in 2^31 are never rolled.
+static int diceRollFast(Rng_t &rng, Dice_t const &dice) {
+    auto &distribution = dice_distributions[(uint16_t) (dice.dice << 8 | dice.sides)];
+    if (distribution.totals.empty()) {
+        distribution = diceDistribution(dice);
+    }
+
+    auto value = (uint32_t) rngNext(rng) - 1;
+
+    uint32_t total = distribution.guide[value >> (31 - distribution.guide_bits)];
+    while (distribution.totals[total] <= value) {
+        total++;
+    }
+
+    return dice.dice + (int) total;
+}
+
 // generates damage for 2d6 style dice rolls
 int diceRoll(Dice_t const &dice) {
+    return diceRoll(rngCurrent(), dice);
+}
+
+// Rolls each die in turn, unless the fast_dice_rolls option is set and there
+// are at least DICE_FAST_ROLL_COUNT of them. The fast rolls follow the same
+// distribution, but use other random numbers, so seeded games play out differently.
+int diceRoll(Rng_t &rng, Dice_t const &dice) {
+    if (config::options::fast_dice_rolls && dice.dice >= DICE_FAST_ROLL_COUNT && dice.sides > 1) {
+        return diceRollFast(rng, dice);
+    }
+
+    int32_t rolls[UINT8_MAX];
+    randomNumbers(rng, dice.sides, rolls, dice.dice);
+
     auto sum = 0;
     for (auto i = 0; i < dice.dice; i++) {
-        sum += randomNumber(dice.sides);
+        sum += rolls[i];
     }
     return sum;
 }
@@ -10,5 +10,9 @@ typedef struct {
     uint8_t sides;
 } Dice_t;
 
+// Fewest dice rolled with one random number when fast_dice_rolls is set
+constexpr uint8_t DICE_FAST_ROLL_COUNT = 8;
+
 int diceRoll(Dice_t const &dice);
+int diceRoll(Rng_t &rng, Dice_t const &dice);
 int maxDiceRoll(Dice_t const &dice);
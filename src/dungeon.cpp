@@ -9,7 +9,7 @@
 
 // The Dungeon global
 // Yup, this initialization is ugly, we'll fix...eventually! -MRC-
-Dungeon_t dg = Dungeon_t{0, 0, {}, -1, 0, true, {}};
+thread_local Dungeon_t dg = Dungeon_t{0, 0, {}, -1, 0, true, {}};
 
 // dungeonDisplayMap shrinks the dungeon to a single screen
 void dungeonDisplayMap() {
@@ -208,6 +208,21 @@ char caveGetTileSymbol(Coord_t const &coord) {
     return '%';
 }
 
+// Puts treasure `treasure_id` on the tile, and records where it lies.
+// Treasures must only be placed in the dungeon with this function.
+void dungeonSetTreasureId(Coord_t const &coord, int treasure_id) {
+    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) treasure_id;
+    game.treasure.positions[treasure_id] = coord;
+    openFloorUpdate(coord);
+}
+
+// Finds the tile treasure `treasure_id` lies on, if it is in the dungeon at all:
+// the recorded position is stale for treasures which have since been removed.
+bool dungeonTreasureIsAt(int treasure_id, Coord_t &coord) {
+    coord = game.treasure.positions[treasure_id];
+    return dg.floor[coord.y][coord.x].treasure_id == treasure_id;
+}
+
 // Tests a spot for light or field mark status -RAK-
 bool caveTileVisible(Coord_t const &coord) {
     return dg.floor[coord.y][coord.x].permanent_light || dg.floor[coord.y][coord.x].temporary_light || dg.floor[coord.y][coord.x].field_mark;
@@ -216,7 +231,7 @@ bool caveTileVisible(Coord_t const &coord) {
 // Places a particular trap at location y, x -RAK-
 void dungeonSetTrap(Coord_t const &coord, int sub_type_id) {
     int free_treasure_id = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+    dungeonSetTreasureId(coord, free_treasure_id);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_TRAP_LIST + sub_type_id, game.treasure.list[free_treasure_id]);
 }
 
@@ -245,8 +260,9 @@ void trapChangeVisibility(Coord_t const &coord) {
 // Places rubble at location y, x -RAK-
 void dungeonPlaceRubble(Coord_t const &coord) {
     int free_treasure_id = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+    dungeonSetTreasureId(coord, free_treasure_id);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
+    losMapChanged();
     inventoryItemCopyTo(config::dungeon::objects::OBJ_RUBBLE, game.treasure.list[free_treasure_id]);
 }
 
@@ -264,7 +280,7 @@ void dungeonPlaceGold(Coord_t const &coord) {
         gold_type_id = config::dungeon::objects::MAX_GOLD_TYPES - 1;
     }
 
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+    dungeonSetTreasureId(coord, free_treasure_id);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_GOLD_LIST + gold_type_id, game.treasure.list[free_treasure_id]);
     game.treasure.list[free_treasure_id].cost += (8L * (int32_t) randomNumber((int) game.treasure.list[free_treasure_id].cost)) + randomNumber(8);
 
@@ -277,7 +293,7 @@ void dungeonPlaceGold(Coord_t const &coord) {
 void dungeonPlaceRandomObjectAt(Coord_t const &coord, bool must_be_small) {
     int free_treasure_id = popt();
 
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) free_treasure_id;
+    dungeonSetTreasureId(coord, free_treasure_id);
 
     int object_id = itemGetRandomObjectId(dg.current_level, must_be_small);
     inventoryItemCopyTo(sorted_objects[object_id], game.treasure.list[free_treasure_id]);
@@ -296,10 +312,9 @@ void dungeonAllocateAndPlaceObject(bool (*set_function)(int), int object_type, i
     for (int i = 0; i < number; i++) {
         // don't put an object beneath the player, this could cause
         // problems if player is standing under rubble, or on a trap.
-        do {
-            coord.y = randomNumber(dg.height) - 1;
-            coord.x = randomNumber(dg.width) - 1;
-        } while (!(*set_function)(dg.floor[coord.y][coord.x].feature_id) || dg.floor[coord.y][coord.x].treasure_id != 0 || (coord.y == py.pos.y && coord.x == py.pos.x));
+        if (!openFloorRandomTile(coord, 0, OPEN_FLOOR_ANY_DISTANCE, set_function)) {
+            return;
+        }
 
         switch (object_type) {
             case 1:
@@ -352,6 +367,12 @@ void dungeonMoveCreatureRecord(Coord_t const &from, Coord_t const &to) {
     int id = dg.floor[from.y][from.x].creature_id;
     dg.floor[from.y][from.x].creature_id = 0;
     dg.floor[to.y][to.x].creature_id = (uint8_t) id;
+    openFloorUpdate(from);
+    openFloorUpdate(to);
+
+    if (id > 1) {
+        monsterScheduleUpdate(id);
+    }
 }
 
 // Room is lit, make it appear -RAK-
@@ -368,7 +389,7 @@ void dungeonLightRoom(Coord_t const &coord) {
 
     for (location.y = top; location.y <= bottom; location.y++) {
         for (location.x = left; location.x <= right; location.x++) {
-            Tile_t &tile = dg.floor[location.y][location.x];
+            Tile_t tile = dg.floor[location.y][location.x];
 
             if (tile.perma_lit_room && !tile.permanent_light) {
                 tile.permanent_light = true;
@@ -405,7 +426,7 @@ static void sub1MoveLight(Coord_t const &from, Coord_t const &to) {
         // Turn off lamp light
         for (int y = from.y - 1; y <= from.y + 1; y++) {
             for (int x = from.x - 1; x <= from.x + 1; x++) {
-                dg.floor[y][x].temporary_light = false;
+                dg.floor.flags[y][x] &= ~TILE_FLAG_TEMPORARY_LIGHT;
             }
         }
         if ((py.running_tracker != 0) && !config::options::run_print_self) {
@@ -417,7 +438,7 @@ static void sub1MoveLight(Coord_t const &from, Coord_t const &to) {
 
     for (int y = to.y - 1; y <= to.y + 1; y++) {
         for (int x = to.x - 1; x <= to.x + 1; x++) {
-            Tile_t &tile = dg.floor[y][x];
+            Tile_t tile = dg.floor[y][x];
 
             // only light up if normal movement
             if (py.temporary_light_only) {
@@ -519,6 +540,8 @@ void dungeonRemoveMonsterFromLevel(int id) {
     monster.hp = -1;
 
     dg.floor[monster.pos.y][monster.pos.x].creature_id = 0;
+    openFloorUpdate(monster.pos);
+    monsterScheduleUpdate(id);
 
     if (monster.lit) {
         dungeonLiteSpot(Coord_t{monster.pos.y, monster.pos.x});
@@ -532,16 +555,9 @@ void dungeonRemoveMonsterFromLevel(int id) {
 // dungeonDeleteMonsterRecord delete the monster record from the monsters list.
 // Called by updateMonsters() and dungeonDeleteMonster() only.
 void dungeonDeleteMonsterRecord(int id) {
-    int last_id = next_free_monster_id - 1;
-    Monster_t &monster = monsters[last_id];
-
-    if (id != last_id) {
-        dg.floor[monster.pos.y][monster.pos.x].creature_id = (uint8_t) id;
-        monsters[id] = monsters[last_id];
-    }
-
-    monsters[last_id] = blank_monster;
-    next_free_monster_id--;
+    monsters[id] = blank_monster;
+    monsterScheduleRemove(id);
+    idPoolRelease(monster_pool, id);
 }
 
 // Creates objects nearby the coordinates given -RAK-
@@ -599,16 +615,18 @@ int dungeonSummonObject(Coord_t coord, int amount, int object_type) {
 
 // Deletes object from given location -RAK-
 bool dungeonDeleteObject(Coord_t const &coord) {
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
 
     if (tile.feature_id == TILE_BLOCKED_FLOOR) {
         tile.feature_id = TILE_CORR_FLOOR;
+        losMapChanged();
     }
 
     pusht(tile.treasure_id);
 
     tile.treasure_id = 0;
     tile.field_mark = false;
+    openFloorUpdate(coord);
 
     dungeonLiteSpot(coord);
 
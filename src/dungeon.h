@@ -35,6 +35,25 @@ typedef struct {
     uint8_t depth_first_found; // Dungeon level item first found
 } DungeonObject_t;
 
+// DungeonFloor_t holds the dungeon tiles as separate planes of bytes, one for
+// each tile field (structure of arrays), so a scan of one field only reads the
+// bytes it needs. `floor[y][x]` gives a Tile_t view of the tile at [y, x].
+struct DungeonFloor_t {
+    uint8_t creature_ids[MAX_HEIGHT][MAX_WIDTH];
+    uint8_t treasure_ids[MAX_HEIGHT][MAX_WIDTH];
+    uint8_t feature_ids[MAX_HEIGHT][MAX_WIDTH];
+    uint8_t flags[MAX_HEIGHT][MAX_WIDTH]; // TILE_FLAG_* bits
+
+    struct Row_t {
+        DungeonFloor_t &floor;
+        int y;
+
+        Tile_t operator[](int x) const { return Tile_t(floor.creature_ids[y][x], floor.treasure_ids[y][x], floor.feature_ids[y][x], floor.flags[y][x]); }
+    };
+
+    Row_t operator[](int y) { return Row_t{*this, y}; }
+};
+
 typedef struct {
     // Dungeon size is either just big enough for town level, or the whole dungeon itself
     int16_t height;
@@ -52,10 +71,10 @@ typedef struct {
     bool generate_new_level;
 
     // Floor definitions
-    Tile_t floor[MAX_HEIGHT][MAX_WIDTH];
+    DungeonFloor_t floor;
 } Dungeon_t;
 
-extern Dungeon_t dg;
+extern thread_local Dungeon_t dg;
 extern DungeonObject_t game_objects[MAX_OBJECTS_IN_GAME];
 
 void dungeonDisplayMap();
@@ -87,10 +106,21 @@ void dungeonRemoveMonsterFromLevel(int id);
 void dungeonDeleteMonsterRecord(int id);
 int dungeonSummonObject(Coord_t coord, int amount, int object_type);
 bool dungeonDeleteObject(Coord_t const &coord);
+void dungeonSetTreasureId(Coord_t const &coord, int treasure_id);
+bool dungeonTreasureIsAt(int treasure_id, Coord_t &coord);
 
 // generate the dungeon
 void generateCave();
 
 // Line of Sight
 bool los(Coord_t from, Coord_t to);
+bool losFromPlayer(Coord_t to);
+bool losTileIsOpaque(Coord_t const &coord);
+void losMapChanged();
 void look();
+
+// Open floor tiles, free for a creature or an object
+constexpr int OPEN_FLOOR_ANY_DISTANCE = MAX_HEIGHT + MAX_WIDTH; // further apart than any two tiles
+void openFloorInvalidate();
+void openFloorUpdate(Coord_t const &coord);
+bool openFloorRandomTile(Coord_t &coord, int min_distance, int max_distance, bool (*feature_set)(int));
@@ -7,8 +7,8 @@
 
 #include "headers.h"
 
-static Coord_t doors_tk[100];
-static int door_index;
+static thread_local Coord_t doors_tk[100];
+static thread_local int door_index;
 
 // Returns a Dark/Light floor tile based on dg.current_level, and random number
 static uint8_t dungeonFloorTileForLevel() {
@@ -60,7 +60,8 @@ static void chanceOfRandomDirection(int &vertical, int &horizontal) {
 
 // Blanks out entire cave -RAK-
 static void dungeonBlankEntireCave() {
-    memset((char *) &dg.floor[0][0], 0, sizeof(dg.floor));
+    memset((char *) &dg.floor, 0, sizeof(dg.floor));
+    openFloorInvalidate();
 }
 
 // Fills in empty spots with desired rock -RAK-
@@ -79,47 +80,17 @@ static void dungeonFillEmptyTilesWith(uint8_t rock_type) {
     }
 }
 
-#ifdef DEBUG
-#include <assert.h>
-#endif
-
 // Places indestructible rock around edges of dungeon -RAK-
 static void dungeonPlaceBoundaryWalls() {
-    Tile_t(*left_ptr)[MAX_WIDTH];
-    Tile_t(*right_ptr)[MAX_WIDTH];
-
     // put permanent wall on leftmost row and rightmost row
-    left_ptr = (Tile_t(*)[MAX_WIDTH]) & dg.floor[0][0];
-    right_ptr = (Tile_t(*)[MAX_WIDTH]) & dg.floor[0][dg.width - 1];
-
-    for (int i = 0; i < dg.height; i++) {
-#ifdef DEBUG
-        assert((Tile_t *) left_ptr == &floor[i][0]);
-        assert((Tile_t *) right_ptr == &floor[i][dg.width - 1]);
-#endif
-
-        ((Tile_t *) left_ptr)->feature_id = TILE_BOUNDARY_WALL;
-        left_ptr++;
-
-        ((Tile_t *) right_ptr)->feature_id = TILE_BOUNDARY_WALL;
-        right_ptr++;
+    for (int y = 0; y < dg.height; y++) {
+        dg.floor.feature_ids[y][0] = TILE_BOUNDARY_WALL;
+        dg.floor.feature_ids[y][dg.width - 1] = TILE_BOUNDARY_WALL;
     }
 
     // put permanent wall on top row and bottom row
-    Tile_t *top_ptr = &dg.floor[0][0];
-    Tile_t *bottom_ptr = &dg.floor[dg.height - 1][0];
-
-    for (int i = 0; i < dg.width; i++) {
-#ifdef DEBUG
-        assert(top_ptr == &floor[0][i]);
-        assert(bottom_ptr == &floor[dg.height - 1][i]);
-#endif
-        top_ptr->feature_id = TILE_BOUNDARY_WALL;
-        top_ptr++;
-
-        bottom_ptr->feature_id = TILE_BOUNDARY_WALL;
-        bottom_ptr++;
-    }
+    memset(dg.floor.feature_ids[0], TILE_BOUNDARY_WALL, (size_t) dg.width);
+    memset(dg.floor.feature_ids[dg.height - 1], TILE_BOUNDARY_WALL, (size_t) dg.width);
 }
 
 // Places "streamers" of rock through dungeon -RAK-
@@ -142,9 +113,12 @@ static void dungeonPlaceStreamerRock(uint8_t rock_type, int chance_of_treasure)
 
     do {
         for (int i = 0; i < config::dungeon::DUN_STREAMER_DENSITY; i++) {
+            int32_t offset[2];
+            randomNumbers(t1, offset, 2);
+
             Coord_t spot = Coord_t{
-                coord.y + randomNumber(t1) - t2,
-                coord.x + randomNumber(t1) - t2,
+                coord.y + offset[0] - t2,
+                coord.x + offset[1] - t2,
             };
 
             if (coordInBounds(spot)) {
@@ -162,14 +136,14 @@ static void dungeonPlaceStreamerRock(uint8_t rock_type, int chance_of_treasure)
 
 static void dungeonPlaceOpenDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_OPEN_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_CORR_FLOOR;
 }
 
 static void dungeonPlaceBrokenDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_OPEN_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_CORR_FLOOR;
     game.treasure.list[cur_pos].misc_use = 1;
@@ -177,14 +151,14 @@ static void dungeonPlaceBrokenDoor(Coord_t coord) {
 
 static void dungeonPlaceClosedDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
 }
 
 static void dungeonPlaceLockedDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
     game.treasure.list[cur_pos].misc_use = (int16_t) (randomNumber(10) + 10);
@@ -192,7 +166,7 @@ static void dungeonPlaceLockedDoor(Coord_t coord) {
 
 static void dungeonPlaceStuckDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
     game.treasure.list[cur_pos].misc_use = (int16_t) (-randomNumber(10) - 10);
@@ -200,7 +174,7 @@ static void dungeonPlaceStuckDoor(Coord_t coord) {
 
 static void dungeonPlaceSecretDoor(Coord_t coord) {
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_SECRET_DOOR, game.treasure.list[cur_pos]);
     dg.floor[coord.y][coord.x].feature_id = TILE_BLOCKED_FLOOR;
 }
@@ -236,7 +210,7 @@ static void dungeonPlaceUpStairs(Coord_t coord) {
     }
 
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_UP_STAIR, game.treasure.list[cur_pos]);
 }
 
@@ -247,7 +221,7 @@ static void dungeonPlaceDownStairs(Coord_t coord) {
     }
 
     int cur_pos = popt();
-    dg.floor[coord.y][coord.x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(coord, cur_pos);
     inventoryItemCopyTo(config::dungeon::objects::OBJ_DOWN_STAIR, game.treasure.list[cur_pos]);
 }
 
@@ -932,7 +906,7 @@ static void dungeonBuildTunnel(Coord_t start, Coord_t end) {
     }
 
     for (int i = 0; i < wall_index; i++) {
-        Tile_t &tile = dg.floor[walls_tk[i].y][walls_tk[i].x];
+        Tile_t tile = dg.floor[walls_tk[i].y][walls_tk[i].x];
 
         if (tile.feature_id == TMP2_WALL) {
             if (randomNumber(100) < config::dungeon::DUN_ROOM_DOORS) {
@@ -965,17 +939,11 @@ static void dungeonPlaceDoorIfNextToTwoWalls(Coord_t coord) {
 
 // Returns random co-ordinates -RAK-
 static void dungeonNewSpot(Coord_t &coord) {
-    Tile_t *tile = nullptr;
-    Coord_t position = Coord_t{0, 0};
-
-    do {
-        position.y = (int32_t) randomNumber(dg.height - 2);
-        position.x = (int32_t) randomNumber(dg.width - 2);
-        tile = &dg.floor[position.y][position.x];
-    } while (tile->feature_id >= MIN_CLOSED_SPACE || tile->creature_id != 0 || tile->treasure_id != 0);
-
-    coord.y = position.y;
-    coord.x = position.x;
+    // The player is not placed yet, so any open floor tile will do.
+    // Every level has open floor, this should never fail.
+    if (!openFloorRandomTile(coord, -1, OPEN_FLOOR_ANY_DISTANCE, nullptr)) {
+        abort();
+    }
 }
 
 // Functions to emulate the original Pascal sets
@@ -1143,7 +1111,7 @@ static void dungeonBuildStore(int store_id, Coord_t coord) {
     dg.floor[y][x].feature_id = TILE_CORR_FLOOR;
 
     int cur_pos = popt();
-    dg.floor[y][x].treasure_id = (uint8_t) cur_pos;
+    dungeonSetTreasureId(Coord_t{y, x}, cur_pos);
 
     inventoryItemCopyTo(config::dungeon::objects::OBJ_STORE_DOOR + store_id, game.treasure.list[cur_pos]);
 }
@@ -1153,7 +1121,7 @@ static void treasureLinker() {
     for (auto &item : game.treasure.list) {
         inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, item);
     }
-    game.treasure.current_id = config::treasure::MIN_TREASURE_LIST_ID;
+    idPoolReset(game.treasure.pool, config::treasure::MIN_TREASURE_LIST_ID, LEVEL_MAX_OBJECTS);
 }
 
 // Link all free space in monster list together
@@ -1161,7 +1129,8 @@ static void monsterLinker() {
     for (auto &monster : monsters) {
         monster = blank_monster;
     }
-    next_free_monster_id = config::monsters::MON_MIN_INDEX_ID;
+    idPoolReset(monster_pool, config::monsters::MON_MIN_INDEX_ID, MON_TOTAL_ALLOCATIONS);
+    monsterScheduleReset();
 }
 
 static void dungeonPlaceTownStores() {
@@ -1218,17 +1187,20 @@ static void lightTown() {
 
 // Town logic flow for generation of new town
 static void townGeneration() {
-    seedSet(game.town_seed);
+    // The town always has the same layout, from a stream of its own
+    Rng_t town_rng = rngCreate((uint32_t) game.town_seed);
+    Rng_t *game_rng = rngSelect(&town_rng);
 
     dungeonPlaceTownStores();
 
     dungeonFillEmptyTilesWith(TILE_DARK_FLOOR);
 
-    // make stairs before seedResetToOldSeed, so that they don't move around
+    // make stairs before going back to the game stream, so that they don't move around
     dungeonPlaceBoundaryWalls();
     dungeonPlaceStairs(2, 1, 0);
 
-    seedResetToOldSeed();
+    (void) rngSelect(game_rng);
+    rngReseed();
 
     // Set up the character coords, used by monsterPlaceNewWithinDistance below
     Coord_t coord = Coord_t{0, 0};
@@ -1275,4 +1247,7 @@ void generateCave() {
     } else {
         dungeonGenerate();
     }
+
+    // The level was built tile by tile, forget any line of sight results from it.
+    losMapChanged();
 }
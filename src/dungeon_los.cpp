@@ -7,6 +7,73 @@
 
 #include "headers.h"
 
+// One bit per tile, set for the tiles which block line of sight and projections,
+// those with a `feature_id` of MIN_CLOSED_SPACE or more. A MAX_WIDTH row fits
+// in four 64-bit words. The map is rebuilt from `dg.floor` on first use after
+// losMapChanged() is called.
+constexpr int OPACITY_MAP_WORDS = (MAX_WIDTH + 63) / 64;
+
+typedef struct {
+    bool valid;
+    uint64_t rows[MAX_HEIGHT][OPACITY_MAP_WORDS];
+} OpacityMap_t;
+
+static thread_local OpacityMap_t opacity_map = {false, {}};
+
+static void opacityMapBuild() {
+    for (int y = 0; y < MAX_HEIGHT; y++) {
+        uint64_t *row = opacity_map.rows[y];
+        const uint8_t *feature_ids = dg.floor.feature_ids[y];
+
+        for (int word = 0; word < OPACITY_MAP_WORDS; word++) {
+            row[word] = 0;
+        }
+
+        for (int x = 0; x < MAX_WIDTH; x++) {
+            if (feature_ids[x] >= MIN_CLOSED_SPACE) {
+                row[x >> 6] |= (uint64_t) 1 << (x & 63);
+            }
+        }
+    }
+
+    opacity_map.valid = true;
+}
+
+static bool opacityMapTest(int y, int x) {
+    return ((opacity_map.rows[y][x >> 6] >> (x & 63)) & 1u) != 0;
+}
+
+// Is any tile from column `first` to `last` (inclusive) on row `y` opaque?
+static bool opacityMapRowBlocked(int y, int first, int last) {
+    const uint64_t *row = opacity_map.rows[y];
+
+    for (int word = first >> 6; word <= last >> 6; word++) {
+        uint64_t mask = ~(uint64_t) 0;
+
+        if (word == first >> 6) {
+            mask &= ~(uint64_t) 0 << (first & 63);
+        }
+        if (word == last >> 6) {
+            mask &= ~(uint64_t) 0 >> (63 - (last & 63));
+        }
+
+        if ((row[word] & mask) != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Does the tile block line of sight and projections (bolts, balls and breaths)?
+bool losTileIsOpaque(Coord_t const &coord) {
+    if (!opacity_map.valid) {
+        opacityMapBuild();
+    }
+
+    return opacityMapTest(coord.y, coord.x);
+}
+
 // A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
 // 4116 Brewster Drive, Raleigh NC 27606.  Email to jnh@ecemwl.ncsu.edu.
 //
@@ -23,6 +90,12 @@
 // Because this function uses (short) ints for all calculations, overflow may
 // occur if deltaX and deltaY exceed 90.
 bool los(Coord_t from, Coord_t to) {
+    profilerCount(COUNT_LOS);
+
+    if (!opacity_map.valid) {
+        opacityMapBuild();
+    }
+
     int delta_x = to.x - from.x;
     int delta_y = to.y - from.y;
 
@@ -40,7 +113,7 @@ bool los(Coord_t from, Coord_t to) {
         }
 
         for (int yy = from.y + 1; yy < to.y; yy++) {
-            if (dg.floor[yy][from.x].feature_id >= MIN_CLOSED_SPACE) {
+            if (opacityMapTest(yy, from.x)) {
                 return false;
             }
         }
@@ -55,13 +128,7 @@ bool los(Coord_t from, Coord_t to) {
             to.x = tmp;
         }
 
-        for (int xx = from.x + 1; xx < to.x; xx++) {
-            if (dg.floor[from.y][xx].feature_id >= MIN_CLOSED_SPACE) {
-                return false;
-            }
-        }
-
-        return true;
+        return !opacityMapRowBlocked(from.y, from.x + 1, to.x - 1);
     }
 
     // Now, we've eliminated all the degenerate cases.
@@ -109,7 +176,7 @@ bool los(Coord_t from, Coord_t to) {
             }
 
             while ((to.x - xx) != 0) {
-                if (dg.floor[yy][xx].feature_id >= MIN_CLOSED_SPACE) {
+                if (opacityMapTest(yy, xx)) {
                     return false;
                 }
 
@@ -119,7 +186,7 @@ bool los(Coord_t from, Coord_t to) {
                     xx += x_sign;
                 } else if (dy > scale_half) {
                     yy += y_sign;
-                    if (dg.floor[yy][xx].feature_id >= MIN_CLOSED_SPACE) {
+                    if (opacityMapTest(yy, xx)) {
                         return false;
                     }
                     xx += x_sign;
@@ -150,7 +217,7 @@ bool los(Coord_t from, Coord_t to) {
         }
 
         while ((to.y - yy) != 0) {
-            if (dg.floor[yy][xx].feature_id >= MIN_CLOSED_SPACE) {
+            if (opacityMapTest(yy, xx)) {
                 return false;
             }
 
@@ -160,7 +227,7 @@ bool los(Coord_t from, Coord_t to) {
                 yy += y_sign;
             } else if (dx > scale_half) {
                 xx += x_sign;
-                if (dg.floor[yy][xx].feature_id >= MIN_CLOSED_SPACE) {
+                if (opacityMapTest(yy, xx)) {
                     return false;
                 }
                 yy += y_sign;
@@ -175,6 +242,56 @@ bool los(Coord_t from, Coord_t to) {
     }
 }
 
+// Results of los() from the player to the tiles around them, out to the
+// monster sight range (config::monsters::MON_MAX_SIGHT). Each result is worked
+// out by los() the first time it's needed, then reused until the player moves
+// or a tile changes between open and closed, see losMapChanged().
+constexpr int LOS_CACHE_RADIUS = 20;
+constexpr int LOS_CACHE_SIZE = LOS_CACHE_RADIUS * 2 + 1;
+
+constexpr uint8_t LOS_UNKNOWN = 0;
+constexpr uint8_t LOS_VISIBLE = 1;
+constexpr uint8_t LOS_BLOCKED = 2;
+
+typedef struct {
+    bool valid;
+    Coord_t from;
+    uint8_t results[LOS_CACHE_SIZE][LOS_CACHE_SIZE];
+} LosCache_t;
+
+static thread_local LosCache_t los_cache = {false, Coord_t{0, 0}, {}};
+
+// Same as `los(py.pos, to)`, but cached for the current player position.
+bool losFromPlayer(Coord_t to) {
+    if (!los_cache.valid || los_cache.from.y != py.pos.y || los_cache.from.x != py.pos.x) {
+        memset(los_cache.results, LOS_UNKNOWN, sizeof(los_cache.results));
+        los_cache.from = py.pos;
+        los_cache.valid = true;
+    }
+
+    int y = to.y - py.pos.y + LOS_CACHE_RADIUS;
+    int x = to.x - py.pos.x + LOS_CACHE_RADIUS;
+
+    if (y < 0 || y >= LOS_CACHE_SIZE || x < 0 || x >= LOS_CACHE_SIZE) {
+        return los(py.pos, to);
+    }
+
+    uint8_t &result = los_cache.results[y][x];
+    if (result == LOS_UNKNOWN) {
+        result = los(py.pos, to) ? LOS_VISIBLE : LOS_BLOCKED;
+    }
+
+    return result == LOS_VISIBLE;
+}
+
+// Must be called whenever a tile `feature_id` is changed outside of level
+// generation, as it may block or open up lines of sight, and monster paths.
+void losMapChanged() {
+    opacity_map.valid = false;
+    los_cache.valid = false;
+    monsterFlowInvalidate();
+}
+
 /*
   An enhanced look, with peripheral vision. Looking all 8 -CJS- directions will
   see everything which ought to be visible. Can specify direction 5, which looks
@@ -224,10 +341,10 @@ bool los(Coord_t from, Coord_t to) {
   dungeon y = py.pos.y + los_fyx * (ray x) + los_fyy * (ray y)
   dungeon x = py.pos.x + los_fxx * (ray x) + los_fxy * (ray y)
 */
-static int los_fxx, los_fxy, los_fyx, los_fyy;
-static int los_num_places_seen;
-static bool los_hack_no_query;
-static int los_rocks_and_objects;
+static thread_local int los_fxx, los_fxy, los_fyx, los_fyy;
+static thread_local int los_num_places_seen;
+static thread_local bool los_hack_no_query;
+static thread_local int los_rocks_and_objects;
 
 // Intended to be indexed by dir/2, since is only
 // relevant to horizontal or vertical directions.
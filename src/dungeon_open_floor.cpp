@@ -0,0 +1,204 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Index of the open floor tiles, used to pick random places for monsters,
+// objects and the player
+
+#include "headers.h"
+
+// The tiles of the current level which are open space with no creature and no
+// object on them, kept as a sparse set of tile numbers (y * MAX_WIDTH + x):
+// `tiles[0..count-1]` holds the members in no particular order, and
+// `positions[tile]` holds the index of the tile in `tiles`, or -1.
+// The set is rebuilt from `dg.floor` on first use after openFloorInvalidate()
+// is called, then kept up to date one tile at a time by openFloorUpdate().
+constexpr int OPEN_FLOOR_MAX_TILES = MAX_HEIGHT * MAX_WIDTH;
+
+// Number of random picks tried before counting the matching tiles one by one.
+constexpr int OPEN_FLOOR_RANDOM_TRIES = 16;
+
+typedef struct {
+    bool valid;
+    int16_t count;
+    int16_t tiles[OPEN_FLOOR_MAX_TILES];
+    int16_t positions[OPEN_FLOOR_MAX_TILES];
+} OpenFloor_t;
+
+static thread_local OpenFloor_t open_floor = {false, 0, {}, {}};
+
+static bool openFloorTileIsOpen(int y, int x) {
+    return dg.floor.feature_ids[y][x] <= MAX_OPEN_SPACE && dg.floor.creature_ids[y][x] == 0 && dg.floor.treasure_ids[y][x] == 0;
+}
+
+static void openFloorAdd(int tile) {
+    open_floor.positions[tile] = open_floor.count;
+    open_floor.tiles[open_floor.count] = (int16_t) tile;
+    open_floor.count++;
+}
+
+static void openFloorRemove(int tile) {
+    int position = open_floor.positions[tile];
+
+    open_floor.count--;
+    int last = open_floor.tiles[open_floor.count];
+    open_floor.tiles[position] = (int16_t) last;
+    open_floor.positions[last] = (int16_t) position;
+
+    open_floor.positions[tile] = -1;
+}
+
+static void openFloorBuild() {
+    open_floor.count = 0;
+
+    // All bits set is -1
+    memset(open_floor.positions, 0xff, sizeof(open_floor.positions));
+
+    // Only the tiles inside the current level, the town is smaller than the map
+    for (int y = 0; y < dg.height; y++) {
+        const uint8_t *feature_ids = dg.floor.feature_ids[y];
+        const uint8_t *creature_ids = dg.floor.creature_ids[y];
+        const uint8_t *treasure_ids = dg.floor.treasure_ids[y];
+
+        for (int x = 0; x < dg.width; x++) {
+            if (feature_ids[x] <= MAX_OPEN_SPACE && (creature_ids[x] | treasure_ids[x]) == 0) {
+                openFloorAdd(y * MAX_WIDTH + x);
+            }
+        }
+    }
+
+    open_floor.valid = true;
+}
+
+// Must be called whenever the whole floor is replaced, when a level is
+// generated or loaded.
+void openFloorInvalidate() {
+    open_floor.valid = false;
+}
+
+// Must be called after the `creature_id` or `treasure_id` of a tile is changed,
+// or its `feature_id` changes between open and closed outside of generation.
+void openFloorUpdate(Coord_t const &coord) {
+    if (!open_floor.valid) {
+        return;
+    }
+
+    int tile = coord.y * MAX_WIDTH + coord.x;
+    bool is_open = openFloorTileIsOpen(coord.y, coord.x);
+    bool was_open = open_floor.positions[tile] >= 0;
+
+    if (is_open && !was_open) {
+        openFloorAdd(tile);
+    } else if (!is_open && was_open) {
+        openFloorRemove(tile);
+    }
+}
+
+static bool openFloorTileMatches(int tile, int min_distance, int max_distance, bool (*feature_set)(int)) {
+    Coord_t coord = Coord_t{tile / MAX_WIDTH, tile % MAX_WIDTH};
+
+    if (feature_set != nullptr && !(*feature_set)(dg.floor.feature_ids[coord.y][coord.x])) {
+        return false;
+    }
+
+    int distance = coordDistanceBetween(coord, py.pos);
+    return distance > min_distance && distance <= max_distance;
+}
+
+// Picks the matching tile numbered `pick` (from 1) in the box of tiles within
+// `radius` rows and columns of the player, or counts them when `pick` is 0.
+static int openFloorScanAroundPlayer(int pick, int radius, int min_distance, bool (*feature_set)(int), Coord_t &coord) {
+    int found = 0;
+
+    int top = std::max(0, py.pos.y - radius);
+    int bottom = std::min(dg.height - 1, py.pos.y + radius);
+    int left = std::max(0, py.pos.x - radius);
+    int right = std::min(dg.width - 1, py.pos.x + radius);
+
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            int tile = y * MAX_WIDTH + x;
+
+            if (open_floor.positions[tile] < 0 || !openFloorTileMatches(tile, min_distance, radius, feature_set)) {
+                continue;
+            }
+
+            found++;
+            if (found == pick) {
+                coord = Coord_t{y, x};
+                return found;
+            }
+        }
+    }
+
+    return found;
+}
+
+// Picks the matching tile numbered `pick` (from 1) in the whole index, or
+// counts them when `pick` is 0.
+static int openFloorScanAll(int pick, int min_distance, int max_distance, bool (*feature_set)(int), Coord_t &coord) {
+    int found = 0;
+
+    for (int position = 0; position < open_floor.count; position++) {
+        int tile = open_floor.tiles[position];
+
+        if (!openFloorTileMatches(tile, min_distance, max_distance, feature_set)) {
+            continue;
+        }
+
+        found++;
+        if (found == pick) {
+            coord = Coord_t{tile / MAX_WIDTH, tile % MAX_WIDTH};
+            return found;
+        }
+    }
+
+    return found;
+}
+
+// Picks a random open floor tile with no creature or object on it, further than
+// `min_distance` and no further than `max_distance` from the player, and with a
+// `feature_id` in `feature_set` (any open feature when nullptr).
+// Returns false, leaving `coord` alone, when there is no such tile.
+bool openFloorRandomTile(Coord_t &coord, int min_distance, int max_distance, bool (*feature_set)(int)) {
+    if (!open_floor.valid) {
+        openFloorBuild();
+    }
+
+    if (open_floor.count == 0) {
+        return false;
+    }
+
+    // A small radius around the player has fewer tiles than the index,
+    // look through those only.
+    int box_side = max_distance * 2 + 1;
+    if (max_distance < MAX_WIDTH && box_side * box_side < open_floor.count) {
+        int found = openFloorScanAroundPlayer(0, max_distance, min_distance, feature_set, coord);
+        if (found == 0) {
+            return false;
+        }
+
+        (void) openFloorScanAroundPlayer(randomNumber(found), max_distance, min_distance, feature_set, coord);
+        return true;
+    }
+
+    // Most of the time the excluded tiles are a small part of the level,
+    // so a few random picks find a match.
+    for (int tries = 0; tries < OPEN_FLOOR_RANDOM_TRIES; tries++) {
+        int tile = open_floor.tiles[randomNumber(open_floor.count) - 1];
+
+        if (openFloorTileMatches(tile, min_distance, max_distance, feature_set)) {
+            coord = Coord_t{tile / MAX_WIDTH, tile % MAX_WIDTH};
+            return true;
+        }
+    }
+
+    int found = openFloorScanAll(0, min_distance, max_distance, feature_set, coord);
+    if (found == 0) {
+        return false;
+    }
+
+    (void) openFloorScanAll(randomNumber(found), min_distance, max_distance, feature_set, coord);
+    return true;
+}
@@ -5,17 +5,48 @@
 
 #pragma once
 
-// Tile_t holds data about a specific tile in the dungeon.
-typedef struct {
-    uint8_t creature_id; // ID for any creature occupying the tile
-    uint8_t treasure_id; // ID for any treasure item occupying the tile
-    uint8_t feature_id;  // ID of cave feature; walls, floors, open space, etc.
-
-    bool perma_lit_room : 1;  // Room should be lit with perm light, walls with this set should be perm lit after tunneled out.
-    bool field_mark : 1;      // Field mark, used for traps/doors/stairs, object is hidden if fm is false.
-    bool permanent_light : 1; // Permanent light, used for walls and lighted rooms.
-    bool temporary_light : 1; // Temporary light, used for player's lamp light,etc.
-} Tile_t;
+// Bits of the tile flags plane, see DungeonFloor_t. These are also the high
+// nibble of each tile byte in the save file.
+constexpr uint8_t TILE_FLAG_PERMA_LIT_ROOM = 1 << 0;
+constexpr uint8_t TILE_FLAG_FIELD_MARK = 1 << 1;
+constexpr uint8_t TILE_FLAG_PERMANENT_LIGHT = 1 << 2;
+constexpr uint8_t TILE_FLAG_TEMPORARY_LIGHT = 1 << 3;
+
+// TileFlag_t is one bit of a tile's flags byte, which reads and assigns like a `bool`.
+struct TileFlag_t {
+    TileFlag_t(uint8_t &tile_flags, uint8_t flag) : flags(tile_flags), mask(flag) {}
+    TileFlag_t(TileFlag_t const &) = default;
+
+    operator bool() const { return (flags & mask) != 0; }
+
+    TileFlag_t &operator=(bool value) {
+        flags = (uint8_t) (value ? flags | mask : flags & ~mask);
+        return *this;
+    }
+
+    TileFlag_t &operator=(TileFlag_t const &other) { return *this = (bool) other; }
+
+  private:
+    uint8_t &flags;
+    uint8_t mask;
+};
+
+// Tile_t is a view of a specific tile in the dungeon, whose data is spread
+// over the planes of the dungeon floor. Get one with `dg.floor[y][x]`.
+struct Tile_t {
+    Tile_t(uint8_t &creature, uint8_t &treasure, uint8_t &feature, uint8_t &flags)
+        : creature_id(creature), treasure_id(treasure), feature_id(feature), perma_lit_room(flags, TILE_FLAG_PERMA_LIT_ROOM), field_mark(flags, TILE_FLAG_FIELD_MARK),
+          permanent_light(flags, TILE_FLAG_PERMANENT_LIGHT), temporary_light(flags, TILE_FLAG_TEMPORARY_LIGHT) {}
+
+    uint8_t &creature_id; // ID for any creature occupying the tile
+    uint8_t &treasure_id; // ID for any treasure item occupying the tile
+    uint8_t &feature_id;  // ID of cave feature; walls, floors, open space, etc.
+
+    TileFlag_t perma_lit_room;  // Room should be lit with perm light, walls with this set should be perm lit after tunneled out.
+    TileFlag_t field_mark;      // Field mark, used for traps/doors/stairs, object is hidden if fm is false.
+    TileFlag_t permanent_light; // Permanent light, used for walls and lighted rooms.
+    TileFlag_t temporary_light; // Temporary light, used for player's lamp light,etc.
+};
 
 // `fval` definitions: these describe the various types of dungeon floors and
 // walls, if numbers above 15 are ever used, then the test against MIN_CAVE_WALL
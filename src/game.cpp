@@ -8,10 +8,7 @@
 #include "headers.h"
 #include "version.h"
 
-// holds the previous rnd state
-static uint32_t old_seed;
-
-Game_t game = Game_t{};
+thread_local Game_t game = Game_t{};
 
 // gets a new random seed for the random number generator
 void seedsInitialize(uint32_t seed) {
@@ -37,26 +34,57 @@ void seedsInitialize(uint32_t seed) {
     }
 }
 
-// change to different random number generator state
-void seedSet(uint32_t seed) {
-    old_seed = getRandomSeed();
+// Generates a random integer x where 1<=X<=MAXVAL -RAK-
+int randomNumber(int const max) {
+    return randomNumber(rngCurrent(), max);
+}
 
-    // want reproducible state here
-    setRandomSeed(seed);
+int randomNumber(Rng_t &rng, int const max) {
+    return (rngNext(rng) % max) + 1;
 }
 
-// restore the normal random generator state
-void seedResetToOldSeed() {
-    setRandomSeed(old_seed);
+// Fills `values` with `count` random numbers from 1 to `max`, the same
+// numbers as `count` calls to randomNumber() give.
+void randomNumbers(int max, int32_t *values, int count) {
+    randomNumbers(rngCurrent(), max, values, count);
 }
 
-// Generates a random integer x where 1<=X<=MAXVAL -RAK-
-int randomNumber(int const max) {
-    return (rnd() % max) + 1;
+// Below this many numbers, dividing for each is quicker than the reciprocal.
+constexpr int RANDOM_NUMBERS_MIN_RECIPROCAL = 4;
+
+// The remainders are found with one division for them all: for n < 2^31,
+// n div max = (n * ceil(2^s / max)) >> s, where s = 31 + ceil(log2(max)).
+void randomNumbers(Rng_t &rng, int max, int32_t *values, int count) {
+    rngFill(rng, values, count);
+
+    if (count < RANDOM_NUMBERS_MIN_RECIPROCAL) {
+        for (int i = 0; i < count; i++) {
+            values[i] = (values[i] % max) + 1;
+        }
+        return;
+    }
+
+    auto divisor = (uint64_t) max;
+
+    int shift = 31;
+    while ((1ULL << (shift - 31)) < divisor) {
+        shift++;
+    }
+    uint64_t reciprocal = ((1ULL << shift) + divisor - 1) / divisor;
+
+    for (int i = 0; i < count; i++) {
+        auto n = (uint64_t) values[i];
+        uint64_t quotient = (n * reciprocal) >> shift;
+        values[i] = (int32_t) (n - quotient * divisor) + 1;
+    }
 }
 
-// Generates a random integer number of NORMAL distribution -RAK-
 int randomNumberNormalDistribution(int mean, int standard) {
+    return randomNumberNormalDistribution(rngCurrent(), mean, standard);
+}
+
+// Generates a random integer number of NORMAL distribution -RAK-
+int randomNumberNormalDistribution(Rng_t &rng, int mean, int standard) {
     // alternate randomNumberNormalDistribution() code, slower but much smaller since no table
     // 2 per 1,000,000 will be > 4*SD, max is 5*SD
     //
@@ -64,58 +92,36 @@ int randomNumberNormalDistribution(int mean, int standard) {
     // tmp = (tmp - 400) * standard / 81;
     // return tmp + mean;
 
-    int tmp = randomNumber(SHRT_MAX);
+    int tmp = randomNumber(rng, SHRT_MAX);
 
     // off scale, assign random value between 4 and 5 times SD
     if (tmp == SHRT_MAX) {
-        int offset = 4 * standard + randomNumber(standard);
+        int offset = 4 * standard + randomNumber(rng, standard);
 
         // one half are negative
-        if (randomNumber(2) == 1) {
+        if (randomNumber(rng, 2) == 1) {
             offset = -offset;
         }
 
         return mean + offset;
     }
 
-    // binary search normal normal_table to get index that
-    // matches tmp this takes up to 8 iterations.
-    int low = 0;
-    int iindex = NORMAL_TABLE_SIZE >> 1;
-    int high = NORMAL_TABLE_SIZE;
-
-    while (true) {
-        if (normal_table[iindex] == tmp || high == low + 1) {
-            break;
-        }
-
-        if (normal_table[iindex] > tmp) {
-            high = iindex;
-            iindex = low + ((iindex - low) >> 1);
-        } else {
-            low = iindex;
-            iindex = iindex + ((high - iindex) >> 1);
-        }
-    }
-
-    // might end up one below target, check that here
-    if (normal_table[iindex] < tmp) {
-        iindex = iindex + 1;
-    }
+    // the normal_table index matching tmp
+    int iindex = normal_table_inverse.index[tmp];
 
     // normal_table is based on SD of 64, so adjust the
     // index value here, round the half way case up.
     int offset = ((standard * iindex) + (NORMAL_TABLE_SD >> 1)) / NORMAL_TABLE_SD;
 
     // one half should be negative
-    if (randomNumber(2) == 1) {
+    if (randomNumber(rng, 2) == 1) {
         offset = -offset;
     }
 
     return mean + offset;
 }
 
-static struct {
+static thread_local struct {
     const char *o_prompt;
     bool *o_var;
 } game_options[] = {
@@ -130,6 +136,9 @@ static struct {
     {"Highlight and notice mineral seams", &config::options::highlight_seams},
     {"Beep for invalid character", &config::options::error_beep_sound},
     {"Display rest/repeat counts", &config::options::display_counts},
+    {"Fast-forward rest/repeat/run", &config::options::fast_forward},
+    {"Monsters chase you around walls", &config::options::monster_pathing},
+    {"Roll many dice with one random number", &config::options::fast_dice_rolls},
     {nullptr, nullptr},
 };
 
@@ -319,11 +328,11 @@ bool getAllDirections(const char *prompt, int &direction) {
     }
 }
 
-// Restore the terminal and exit
+// Restore the terminal and exit the game, see startMoria()
 void exitProgram() {
     flushInputBuffer();
     terminalRestore();
-    exit(0);
+    throw GameExit_t{};
 }
 
 // Abort the program with a message displayed on the terminal.
@@ -14,14 +14,23 @@ constexpr uint16_t MAX_OBJECTS_IN_GAME = 420; // Number of objects for universe
 constexpr uint16_t MAX_DUNGEON_OBJECTS = 344; // Number of dungeon objects
 constexpr uint16_t OBJECT_IDENT_SIZE = 448;   // 7*64, see object_offset() in desc.cpp, could be MAX_OBJECTS o_o() rewritten
 
-// With LEVEL_MAX_OBJECTS set to 150, it's possible to get compacting
-// objects during level generation, although it is extremely rare.
-constexpr uint8_t LEVEL_MAX_OBJECTS = 175; // Max objects per level
+// Size of the treasure list, including the unused id 0. Objects are compacted
+// (distant ones deleted) only when the list is full. It may be raised as far as
+// ID_POOL_MAX_IDS.
+constexpr uint16_t LEVEL_MAX_OBJECTS = 175; // Max objects per level
+static_assert(LEVEL_MAX_OBJECTS <= ID_POOL_MAX_IDS, "treasure ids must fit in a tile byte");
 
 // definitions for the pseudo-normal distribution generation
 constexpr uint16_t NORMAL_TABLE_SIZE = 256;
 constexpr uint8_t NORMAL_TABLE_SD = 64; // the standard deviation for the table
 
+// The normal_table index for every value randomNumber(SHRT_MAX) draws, bar the
+// off scale SHRT_MAX itself. Built from normal_table when compiling, so drawing
+// a normal number is one lookup rather than a binary search.
+typedef struct {
+    uint8_t index[SHRT_MAX];
+} NormalTableInverse_t;
+
 // Inventory command screen states.
 enum class Screen {
     Blank = 0,
@@ -57,8 +66,9 @@ typedef struct Game_t {
     vtype_t character_died_from = {'\0'}; // What the character died from: starvation, Bat, etc.
 
     struct {
-        int16_t current_id = 0; // Current treasure heap ptr
+        IdPool_t pool{}; // Ids in use in the treasure list
         Inventory_t list[LEVEL_MAX_OBJECTS]{};
+        Coord_t positions[LEVEL_MAX_OBJECTS]{}; // Dungeon location of each treasure, see dungeonSetTreasureId()
     } treasure;
 
     // Keep track of the state of the current screen (inventory, equipment, help, etc.).
@@ -71,17 +81,23 @@ typedef struct Game_t {
     } screen;
 } Game_t;
 
-extern Game_t game;
+// All live game state (`game`, `dg`, `py`, `monsters`, `stores`, the message
+// history, the RNG seed, etc.) is `thread_local`, so each thread calling
+// startMoria() plays its own independent game. Start a fresh thread for
+// every game as that state is only initialized when the thread starts.
+extern thread_local Game_t game;
 
 extern int16_t sorted_objects[MAX_DUNGEON_OBJECTS];
-extern uint16_t normal_table[NORMAL_TABLE_SIZE];
+extern const NormalTableInverse_t normal_table_inverse;
 extern int16_t treasure_levels[TREASURE_MAX_LEVELS + 1];
 
 void seedsInitialize(uint32_t seed);
-void seedSet(uint32_t seed);
-void seedResetToOldSeed();
 int randomNumber(int max);
+int randomNumber(Rng_t &rng, int max);
+void randomNumbers(int max, int32_t *values, int count);
+void randomNumbers(Rng_t &rng, int max, int32_t *values, int count);
 int randomNumberNormalDistribution(int mean, int standard);
+int randomNumberNormalDistribution(Rng_t &rng, int mean, int standard);
 void setGameOptions();
 bool validGameVersion(uint8_t major, uint8_t minor, uint8_t patch);
 bool isCurrentGameVersion(uint8_t major, uint8_t minor, uint8_t patch);
@@ -90,6 +106,11 @@ int getRandomDirection();
 bool getDirectionWithMemory(char *prompt, int &direction);
 bool getAllDirections(const char *prompt, int &direction);
 
+// Thrown by exitProgram() so the game unwinds back out of startMoria()
+// rather than exiting the process from whichever thread is playing it.
+typedef struct {
+} GameExit_t;
+
 void exitProgram();
 void abortProgram(const char *msg);
 
@@ -111,9 +132,50 @@ void endGame();
 
 // save/load
 bool saveGame();
+void autosaveGame();
+void autosaveFinish();
+uint64_t saveStateHash();
 bool loadGame(bool &generate);
 void setFileptr(FILE *file);
 
 // game_run.cpp
 // (includes the playDungeon() main game loop)
 void startMoria(uint32_t seed, bool start_new_game, bool roguelike_keys);
+
+// game_simulate.cpp
+void simulateGames(uint32_t first_seed, int games, int workers);
+
+// game_replay.cpp
+bool replayRecordStart(const char *filename, uint32_t &seed, bool roguelike_keys);
+bool replayRecordFinish();
+void replayGameOver();
+int replayPlay(const char *filename);
+
+// game_profile.cpp
+// Time spent in each phase of a playDungeon() turn, see profilerMark().
+enum ProfilePhase {
+    PHASE_STORES,
+    PHASE_MONSTER_SPAWNING,
+    PHASE_PLAYER_STATUS,
+    PHASE_INTERRUPT_CHECK,
+    PHASE_PLAYER_COMMANDS,
+    PHASE_MONSTERS,
+};
+constexpr uint8_t PROFILE_PHASES = 6;
+
+// Work counted while profiling, see profilerCount().
+enum ProfileCounter {
+    COUNT_MONSTERS,
+    COUNT_LOS,
+    COUNT_TILES,
+    COUNT_TILES_UNCHANGED,
+};
+constexpr uint8_t PROFILE_COUNTERS = 4;
+
+void profilerEnable(const std::string &filename);
+bool profilerEnabled();
+void profilerTurnStart();
+void profilerMark(ProfilePhase phase);
+void profilerCount(ProfileCounter counter);
+void profilerCountMany(ProfileCounter counter, int amount);
+void profilerReport();
@@ -139,6 +139,9 @@ void endGame() {
         (void) saveGame();
     }
 
+    // A recorded game is over, whatever the score file holds
+    replayGameOver();
+
     // add score to score file if applicable
     if (game.character_generated) {
         // Clear `game.character_saved`, strange thing to do, but it prevents
@@ -22,7 +22,7 @@ static void compactObjects() {
     while (counter <= 0) {
         for (coord.y = 0; coord.y < dg.height; coord.y++) {
             for (coord.x = 0; coord.x < dg.width; coord.x++) {
-                if (dg.floor[coord.y][coord.x].treasure_id != 0 && coordDistanceBetween(coord, py.pos) > current_distance) {
+                if (dg.floor.treasure_ids[coord.y][coord.x] != 0 && coordDistanceBetween(coord, py.pos) > current_distance) {
                     int chance;
 
                     switch (game.treasure.list[dg.floor[coord.y][coord.x].treasure_id].category_id) {
@@ -68,32 +68,22 @@ static void compactObjects() {
 
 // Gives pointer to next free space -RAK-
 int popt() {
-    if (game.treasure.current_id == LEVEL_MAX_OBJECTS) {
+    int treasure_id = idPoolAllocate(game.treasure.pool);
+
+    if (treasure_id == -1) {
         compactObjects();
+        treasure_id = idPoolAllocate(game.treasure.pool);
     }
 
-    return game.treasure.current_id++;
+    return treasure_id;
 }
 
 // Pushes a record back onto free space list -RAK-
 // `dungeonDeleteObject()` should always be called instead, unless the object
 // in question is not in the dungeon, e.g. in store1.c and files.c
 void pusht(uint8_t treasure_id) {
-    if (treasure_id != game.treasure.current_id - 1) {
-        game.treasure.list[treasure_id] = game.treasure.list[game.treasure.current_id - 1];
-
-        // must change the treasure_id in the cave of the object just moved
-        for (int y = 0; y < dg.height; y++) {
-            for (int x = 0; x < dg.width; x++) {
-                if (dg.floor[y][x].treasure_id == game.treasure.current_id - 1) {
-                    dg.floor[y][x].treasure_id = treasure_id;
-                }
-            }
-        }
-    }
-    game.treasure.current_id--;
-
-    inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, game.treasure.list[game.treasure.current_id]);
+    inventoryItemCopyTo(config::dungeon::objects::OBJ_NOTHING, game.treasure.list[treasure_id]);
+    idPoolRelease(game.treasure.pool, treasure_id);
 }
 
 // Item too large to fit in chest? -DJG-
@@ -0,0 +1,111 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Optional per-turn profiling of the playDungeon() phases, reported per level
+
+#include "headers.h"
+
+static const char *profile_phase_names[PROFILE_PHASES] = {
+    "store maintenance",
+    "monster spawning",
+    "player status",
+    "interrupt check",
+    "player commands",
+    "monsters",
+};
+
+static const char *profile_counter_names[PROFILE_COUNTERS] = {
+    "monsters processed",
+    "los calls",
+    "tiles drawn",
+    "tiles unchanged",
+};
+
+// Profile_t holds the timings and counts for the current level
+typedef struct {
+    int16_t level;
+    int32_t turns;
+    uint64_t phase_nanoseconds[PROFILE_PHASES];
+    uint64_t counters[PROFILE_COUNTERS];
+    std::chrono::steady_clock::time_point last_mark;
+} Profile_t;
+
+// Set once before any game starts, and shared by all of them.
+static std::string profile_filename;
+static std::mutex profile_mutex;
+
+static thread_local Profile_t profile{};
+
+// Profile every game, appending the reports to `filename`.
+void profilerEnable(const std::string &filename) {
+    profile_filename = filename;
+}
+
+bool profilerEnabled() {
+    return !profile_filename.empty();
+}
+
+// Start timing a new turn on the given level.
+void profilerTurnStart() {
+    if (profile_filename.empty()) {
+        return;
+    }
+
+    if (profile.turns == 0) {
+        profile.level = dg.current_level;
+    }
+    profile.turns++;
+    profile.last_mark = std::chrono::steady_clock::now();
+}
+
+// Charges the time since the previous mark to `phase`.
+void profilerMark(ProfilePhase phase) {
+    if (profile_filename.empty()) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    profile.phase_nanoseconds[phase] += (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(now - profile.last_mark).count();
+    profile.last_mark = now;
+}
+
+void profilerCount(ProfileCounter counter) {
+    profile.counters[counter]++;
+}
+
+void profilerCountMany(ProfileCounter counter, int amount) {
+    profile.counters[counter] += (uint64_t) amount;
+}
+
+// Appends the report for the current level to the profile file, and starts over.
+void profilerReport() {
+    if (profile_filename.empty() || profile.turns == 0) {
+        profile = Profile_t{};
+        return;
+    }
+
+    uint64_t total = 0;
+    for (auto nanoseconds : profile.phase_nanoseconds) {
+        total += nanoseconds;
+    }
+
+    std::lock_guard<std::mutex> lock(profile_mutex);
+
+    FILE *file = fopen(profile_filename.c_str(), "a");
+    if (file != nullptr) {
+        (void) fprintf(file, "%s, level %d: %d turns, %.3f ms (%.1f us/turn)\n", py.misc.name, profile.level, profile.turns, total / 1e6, total / 1e3 / profile.turns);
+
+        for (int i = 0; i < PROFILE_PHASES; i++) {
+            (void) fprintf(file, "    %-20s %10.3f ms %6.1f%%\n", profile_phase_names[i], profile.phase_nanoseconds[i] / 1e6, total == 0 ? 0.0 : 100.0 * profile.phase_nanoseconds[i] / total);
+        }
+        for (int i = 0; i < PROFILE_COUNTERS; i++) {
+            (void) fprintf(file, "    %-20s %10llu %8.1f/turn\n", profile_counter_names[i], (unsigned long long) profile.counters[i], (double) profile.counters[i] / profile.turns);
+        }
+
+        (void) fclose(file);
+    }
+
+    profile = Profile_t{};
+}
@@ -0,0 +1,358 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Replays: games recorded key by key, then played back headless to check they end the same
+
+#include "headers.h"
+#include "version.h"
+
+// A replay file starts with a text header, one `name value` per line:
+//
+//   umoria-replay 1
+//   version 5.7.15
+//   seed 1634000000
+//   time 1634000000
+//   roguelike 0
+//   wizard 0
+//   events
+//
+// then one event for every key read and every key check of the game:
+//
+//   'k' and the key byte, 'e' for the end of input, or 's' for the end of a key script
+//   '.' when no key was pressed, 'p' when one was, or 'x' for the end of input
+//
+// and once the game is over, 'h' and the saveStateHash() of the game as 16
+// hex digits. The game is over once endGame() is about to record the score,
+// see replayGameOver(), or else when the game stops.
+//
+// The game clock is stopped at `time` while recording and replaying, for the
+// date of birth and the save times.
+constexpr int REPLAY_FORMAT = 1;
+
+// ReplayHeader_t holds what is needed to start the recorded game again
+typedef struct {
+    int format;
+    int version_major;
+    int version_minor;
+    int version_patch;
+    uint32_t seed;
+    uint32_t time;
+    int roguelike_keys;
+    int wizard;
+} ReplayHeader_t;
+
+typedef struct {
+    FILE *file;
+} ReplayRecording_t;
+
+typedef struct {
+    std::string events;
+    size_t position;
+    int keys;
+    bool playing;
+    bool out_of_step; // the game asked for a key or key check the recording does not have
+} ReplayPlayback_t;
+
+// The state of the game once it is over
+typedef struct {
+    bool reached;
+    uint64_t hash;
+} ReplayGameOver_t;
+
+static thread_local ReplayRecording_t replay_recording = {nullptr};
+static thread_local ReplayPlayback_t replay_playback = {"", 0, 0, false, false};
+static thread_local ReplayGameOver_t replay_game_over = {false, 0};
+
+//
+// Recording
+//
+
+static void replayRecordKey(int key, bool end_of_script) {
+    if (end_of_script) {
+        (void) putc('s', replay_recording.file);
+        return;
+    }
+    if (key == EOF) {
+        (void) putc('e', replay_recording.file);
+        return;
+    }
+    (void) putc('k', replay_recording.file);
+    (void) putc(key, replay_recording.file);
+}
+
+static void replayRecordKeyCheck(bool pending, bool end_of_input) {
+    char event = '.';
+    if (end_of_input) {
+        event = 'x';
+    } else if (pending) {
+        event = 'p';
+    }
+    (void) putc(event, replay_recording.file);
+}
+
+// Records the new game about to be started to `filename`. A `seed` of 0 is
+// replaced by the clock seed seedsInitialize() would have picked.
+// The save file must not exist yet: saving over a file the game did not
+// create asks the player what to do, with prompts a replay can not match.
+bool replayRecordStart(const char *filename, uint32_t &seed, bool roguelike_keys) {
+    if (access(config::files::save_game.c_str(), 0) == 0) {
+        return false;
+    }
+
+    replay_recording.file = fopen(filename, "wb");
+    if (replay_recording.file == nullptr) {
+        return false;
+    }
+
+    uint32_t now = getCurrentUnixTime();
+    if (seed == 0) {
+        seed = now;
+    }
+    setFixedUnixTime(now);
+
+    fprintf(replay_recording.file, "umoria-replay %d\n", REPLAY_FORMAT);
+    fprintf(replay_recording.file, "version %d.%d.%d\n", CURRENT_VERSION_MAJOR, CURRENT_VERSION_MINOR, CURRENT_VERSION_PATCH);
+    fprintf(replay_recording.file, "seed %u\n", seed);
+    fprintf(replay_recording.file, "time %u\n", now);
+    fprintf(replay_recording.file, "roguelike %d\n", roguelike_keys ? 1 : 0);
+    fprintf(replay_recording.file, "wizard %d\n", game.to_be_wizard ? 1 : 0);
+    fprintf(replay_recording.file, "events\n");
+
+    replay_game_over.reached = false;
+    inputRecord(replayRecordKey, replayRecordKeyCheck);
+
+    return true;
+}
+
+// Ends the recording with the state hash of the game just played.
+bool replayRecordFinish() {
+    inputRecord(nullptr, nullptr);
+
+    uint64_t hash = replay_game_over.reached ? replay_game_over.hash : saveStateHash();
+    fprintf(replay_recording.file, "h%016llx\n", (unsigned long long) hash);
+
+    bool ok = ferror(replay_recording.file) == 0;
+    if (fclose(replay_recording.file) != 0) {
+        ok = false;
+    }
+    replay_recording.file = nullptr;
+
+    setFixedUnixTime(0);
+
+    return ok;
+}
+
+// Called by endGame() once the character is buried or saved, before the score
+// is recorded. What follows depends on the score file rather than the game, so
+// the final state is taken here: a recording stops, and a replay is over.
+void replayGameOver() {
+    if (replay_recording.file == nullptr && !replay_playback.playing) {
+        return;
+    }
+
+    replay_game_over.hash = saveStateHash();
+    replay_game_over.reached = true;
+
+    inputRecord(nullptr, nullptr);
+
+    if (replay_playback.playing) {
+        exitProgram();
+    }
+}
+
+//
+// Playback
+//
+
+// Stops the game once it no longer follows the recording.
+static void replayOutOfStep() {
+    replay_playback.out_of_step = true;
+    inputEndOfScript();
+}
+
+static int replayNextEvent() {
+    if (replay_playback.position >= replay_playback.events.size()) {
+        return EOF;
+    }
+    return (unsigned char) replay_playback.events[replay_playback.position++];
+}
+
+static int replayReadKey() {
+    if (replay_playback.out_of_step || replay_game_over.reached) {
+        return EOF;
+    }
+
+    int event = replayNextEvent();
+
+    if (event == 'k' && replay_playback.position < replay_playback.events.size()) {
+        replay_playback.keys++;
+        return replayNextEvent();
+    }
+    if (event == 'e') {
+        return EOF;
+    }
+    if (event == 's') {
+        inputEndOfScript();
+    }
+
+    replayOutOfStep();
+    return EOF;
+}
+
+static bool replayKeyPending() {
+    if (replay_playback.out_of_step || replay_game_over.reached) {
+        return false;
+    }
+
+    switch (replayNextEvent()) {
+        case '.':
+            return false;
+        case 'p':
+            return true;
+        case 'x':
+            eof_flag++;
+            return false;
+        default:
+            replayOutOfStep();
+            return false;
+    }
+}
+
+static bool replayReadFile(const char *filename, std::string &contents) {
+    FILE *file = fopen(filename, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    char buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, length);
+    }
+
+    bool ok = ferror(file) == 0;
+    (void) fclose(file);
+
+    return ok;
+}
+
+// Splits the header from the events, which are left in `contents`.
+static bool replayReadHeader(std::string &contents, ReplayHeader_t &header) {
+    const char *end_of_header = "\nevents\n";
+
+    size_t events = contents.find(end_of_header);
+    if (events == std::string::npos) {
+        return false;
+    }
+
+    std::string text = contents.substr(0, events);
+    contents.erase(0, events + strlen(end_of_header));
+
+    int fields = sscanf(text.c_str(),
+                        "umoria-replay %d version %d.%d.%d seed %u time %u roguelike %d wizard %d",
+                        &header.format, &header.version_major, &header.version_minor, &header.version_patch,
+                        &header.seed, &header.time, &header.roguelike_keys, &header.wizard);
+
+    return fields == 8;
+}
+
+// Picks the scratch save file for replaying `filename`: the first of `FILE.sav`,
+// `FILE.1.sav`, `FILE.2.sav`, ... which does not exist. Saving over a file the
+// game did not create asks the player what to do, and someone else's file must
+// not be deleted once the replay is over.
+static std::string replayScratchSaveFile(const char *filename) {
+    std::string scratch = std::string(filename) + ".sav";
+
+    for (int suffix = 1; access(scratch.c_str(), 0) == 0; suffix++) {
+        scratch = std::string(filename) + "." + std::to_string(suffix) + ".sav";
+    }
+
+    return scratch;
+}
+
+// Plays back the game recorded in `filename` headless, as fast as it goes,
+// then checks the game ended in the same state as when it was recorded.
+// Returns the exit code: 0 when the states match, 1 otherwise.
+int replayPlay(const char *filename) {
+    std::string contents;
+    ReplayHeader_t header{};
+
+    if (!replayReadFile(filename, contents)) {
+        printf("Can't read replay file '%s'\n", filename);
+        return 1;
+    }
+    if (!replayReadHeader(contents, header) || header.format != REPLAY_FORMAT) {
+        printf("'%s' is not a replay file\n", filename);
+        return 1;
+    }
+    if (header.version_major != CURRENT_VERSION_MAJOR || header.version_minor != CURRENT_VERSION_MINOR || header.version_patch != CURRENT_VERSION_PATCH) {
+        printf("'%s' was recorded with version %d.%d.%d\n", filename, header.version_major, header.version_minor, header.version_patch);
+        return 1;
+    }
+
+    // The recording ends with the state hash, which is not an input event.
+    unsigned long long recorded_hash = 0;
+    bool has_hash = false;
+
+    size_t hash_at = contents.size() - std::min(contents.size(), (size_t) 18);
+    if (contents.size() >= 18 && contents[hash_at] == 'h' && sscanf(contents.c_str() + hash_at, "h%16llx\n", &recorded_hash) == 1) {
+        has_hash = true;
+        contents.erase(hash_at);
+    }
+
+    replay_playback.events = contents;
+    replay_playback.position = 0;
+    replay_playback.keys = 0;
+    replay_playback.playing = true;
+    replay_playback.out_of_step = false;
+    replay_game_over.reached = false;
+
+    rendererSelect(Renderer::Framebuffer);
+    (void) terminalInitialize();
+
+    // Nothing the recording did not do: no waiting, no autosaves, and
+    // the save made at the end of the game goes to a new scratch file.
+    config::options::fast_forward = true;
+    config::files::autosave_turns = 0;
+    config::files::save_game = replayScratchSaveFile(filename);
+    game.to_be_wizard = header.wizard != 0;
+
+    setFixedUnixTime(header.time);
+    inputSelectReplay(replayReadKey, replayKeyPending);
+
+    auto start = std::chrono::steady_clock::now();
+
+    startMoria(header.seed, true, header.roguelike_keys != 0);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    uint64_t hash = replay_game_over.reached ? replay_game_over.hash : saveStateHash();
+    replay_playback.playing = false;
+    setFixedUnixTime(0);
+    (void) unlink(config::files::save_game.c_str());
+
+    if (replay_playback.position < replay_playback.events.size()) {
+        replay_playback.out_of_step = true;
+    }
+
+    printf("%s: %d keys, %d points, %.3f ms\n", filename, replay_playback.keys, playerCalculateTotalPoints(), elapsed.count());
+    printf("final state %016llx\n", (unsigned long long) hash);
+
+    if (!has_hash) {
+        printf("MISMATCH, the recording has no final state as it did not finish\n");
+        return 1;
+    }
+    if (replay_playback.out_of_step) {
+        printf("MISMATCH, the game went out of step with the recording after %d keys\n", replay_playback.keys);
+        return 1;
+    }
+    if (hash != recorded_hash) {
+        printf("MISMATCH, recorded final state %016llx\n", recorded_hash);
+        return 1;
+    }
+
+    printf("match\n");
+    return 0;
+}
@@ -7,6 +7,7 @@
 
 #include "headers.h"
 
+static void playGame(uint32_t seed, bool start_new_game, bool roguelike_keys);
 static void playDungeon();
 
 static void initializeCharacterInventory();
@@ -25,12 +26,37 @@ static void dungeonGoDownLevel();
 static void dungeonJamDoor();
 static void inventoryRefillLamp();
 
+// Plays a game until the character is buried, or the game is saved.
+// Returns once the game has ended, which may be on a thread of its own.
 void startMoria(uint32_t seed, bool start_new_game, bool roguelike_keys) {
+    try {
+        playGame(seed, start_new_game, roguelike_keys);
+    } catch (GameExit_t const &) {
+        // exitProgram() was called, the game is over.
+    }
+
+    autosaveFinish();
+
+    // Report on the level the game ended on
+    profilerReport();
+}
+
+// The object and monster tables are shared by every game in the process,
+// so they are only adjusted once.
+static std::once_flag game_tables_initialized;
+
+static void playGame(uint32_t seed, bool start_new_game, bool roguelike_keys) {
     // Start the game with Roguelike keys (disabled by default)
     // NOTE: this will be overridden by the game save file.
     config::options::use_roguelike_keys = roguelike_keys;
 
-    priceAdjust();
+    std::call_once(game_tables_initialized, []() {
+        priceAdjust();
+
+        // Init monster and treasure levels for allocate
+        initializeMonsterLevels();
+        initializeTreasureLevels();
+    });
 
     // Show the game splash screen
     displaySplashScreen();
@@ -38,10 +64,6 @@ void startMoria(uint32_t seed, bool start_new_game, bool roguelike_keys) {
     // Grab a random seed from the clock
     seedsInitialize(seed);
 
-    // Init monster and treasure levels for allocate
-    initializeMonsterLevels();
-    initializeTreasureLevels();
-
     // Init the store inventories
     storeInitializeOwners();
 
@@ -149,6 +171,7 @@ void startMoria(uint32_t seed, bool start_new_game, bool roguelike_keys) {
         // New level if not dead
         if (!game.character_is_dead) {
             generateCave();
+            autosaveGame();
         }
     }
 
@@ -256,6 +279,7 @@ static void resetDungeonFlags() {
     game.teleport_player = false;
     monster_multiply_total = 0;
     dg.floor[py.pos.y][py.pos.x].creature_id = 1;
+    openFloorUpdate(py.pos);
 }
 
 // Check light status for dungeon setup
@@ -2322,15 +2346,19 @@ static void playDungeon() {
         // Increment turn counter
         dg.game_turn++;
 
+        profilerTurnStart();
+
         // turn over the store contents every, say, 1000 turns
         if (dg.current_level != 0 && dg.game_turn % 1000 == 0) {
             storeMaintenance();
         }
+        profilerMark(PHASE_STORES);
 
         // Check for creature generation
         if (randomNumber(config::monsters::MON_CHANCE_OF_NEW) == 1) {
             monsterPlaceNewWithinDistance(1, config::monsters::MON_MAX_SIGHT, false);
         }
+        profilerMark(PHASE_MONSTER_SPAWNING);
 
         playerUpdateLightStatus();
 
@@ -2350,12 +2378,15 @@ static void playDungeon() {
         playerUpdatePoisonedState();
         playerUpdateSpeed();
         playerUpdateRestingState();
+        profilerMark(PHASE_PLAYER_STATUS);
 
         // Check for interrupts to find or rest.
-        int microseconds = (py.running_tracker != 0 ? 0 : 10000);
-        if ((game.command_count > 0 || (py.running_tracker != 0) || py.flags.rest != 0) && checkForNonBlockingKeyPress(microseconds)) {
+        // When fast-forwarding we only poll, and never wait for a key press.
+        int microseconds = (py.running_tracker != 0 || config::options::fast_forward ? 0 : 10000);
+        if (playerIsBusy() && checkForNonBlockingKeyPress(microseconds)) {
             playerDisturb(0, 0);
         }
+        profilerMark(PHASE_INTERRUPT_CHECK);
 
         playerUpdateHallucination();
         playerUpdateParalysis();
@@ -2392,15 +2423,7 @@ static void playDungeon() {
         if ((dg.game_turn & 0xF) == 0 && py.flags.confused == 0 && randomNumber(chance) == 1) {
             playerDetectEnchantment();
         }
-
-        // Check the state of the monster list, and delete some monsters if
-        // the monster list is nearly full.  This helps to avoid problems in
-        // creature.c when monsters try to multiply.  Compact_monsters() is
-        // much more likely to succeed if called from here, than if called
-        // from within updateMonsters().
-        if (MON_TOTAL_ALLOCATIONS - next_free_monster_id < 10) {
-            (void) compactMonsters();
-        }
+        profilerMark(PHASE_PLAYER_STATUS);
 
         // Accept a command?
         if (py.flags.paralysis < 1 && py.flags.rest == 0 && !game.character_is_dead) {
@@ -2416,10 +2439,19 @@ static void playDungeon() {
         if (game.teleport_player) {
             playerTeleport(100);
         }
+        profilerMark(PHASE_PLAYER_COMMANDS);
 
         // Move the creatures
         if (!dg.generate_new_level) {
             updateMonsters(true);
         }
+        profilerMark(PHASE_MONSTERS);
+
+        // New levels are saved once they are made, see playGame()
+        if (config::files::autosave_turns > 0 && dg.game_turn % config::files::autosave_turns == 0 && !dg.generate_new_level) {
+            autosaveGame();
+        }
     } while (!dg.generate_new_level && (eof_flag == 0));
+
+    profilerReport();
 }
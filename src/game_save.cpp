@@ -15,15 +15,48 @@
 
 DEBUG(static FILE *logfile)
 
+// Save file formats:
+// - Version 1 starts with the game version and a random byte, then every byte
+//   after is XOR'd with the one before it. Strings end at their '\0', and the
+//   tiles of the level are run length encoded.
+// - Version 2 starts with SAVE_V2_MAGIC and the game version, then holds the
+//   same values in the same order, but as plain little endian bytes in
+//   sections. Each section starts with its SaveSection and a 32 bit length.
+//   Strings are padded to their full size and each tile is one byte, so the
+//   records in a section have a fixed layout.
+// Games are always saved as version 2, both versions can be restored.
+// The score file records use the version 1 encoding.
+constexpr int SAVE_FORMAT_V1 = 1;
+constexpr int SAVE_FORMAT_V2 = 2;
+
+static const uint8_t SAVE_V2_MAGIC[4] = {'U', 'M', 'S', 2};
+
+enum SaveSection {
+    SAVE_SECTION_RECALL = 1,
+    SAVE_SECTION_CHARACTER,
+    SAVE_SECTION_STORES,
+    SAVE_SECTION_SUMMARY,
+    SAVE_SECTION_LEVEL,
+    SAVE_SECTION_TREASURE,
+    SAVE_SECTION_MONSTERS,
+};
+
 static bool saveChar(const std::string &filename);
-static bool svWrite();
+static void svWrite();
+
+static bool svReadFile();
+static void wrSectionStart(SaveSection section);
+static void wrSectionEnd();
+static bool rdSectionStart(SaveSection section);
+static bool rdSectionEnd();
 
+static void putByte(uint8_t value);
 static void wrBool(bool value);
 static void wrByte(uint8_t value);
 static void wrShort(uint16_t value);
 static void wrLong(uint32_t value);
-static void wrBytes(uint8_t *value, int count);
-static void wrString(char *str);
+static void wrBytes(const uint8_t *value, int count);
+static void wrString(const char *str, int size);
 static void wrShorts(uint16_t *value, int count);
 
 static void wrItem(Inventory_t &item);
@@ -36,17 +69,35 @@ static uint8_t rdByte();
 static uint16_t rdShort();
 static uint32_t rdLong();
 static void rdBytes(uint8_t *value, int count);
-static void rdString(char *str);
+static void rdString(char *str, int size);
 static void rdShorts(uint16_t *value, int count);
 
 static void rdItem(Inventory_t &item);
 static void rdMonster(Monster_t &monster);
 
 // these are used for the save file, to avoid having to pass them to every procedure
-static FILE *fileptr;
-static uint8_t xor_byte;
-static int from_save_file;  // can overwrite old save file when save
-static uint32_t start_time; // time that play started
+static thread_local FILE *fileptr;
+static thread_local uint8_t xor_byte;
+static thread_local int from_save_file;  // can overwrite old save file when save
+static thread_local uint32_t start_time; // time that play started
+
+// A save file is built up in `save_buffer` and written with a single call,
+// and is read back into it whole. The score file is still read and written
+// a byte at a time through `fileptr`.
+static thread_local std::vector<uint8_t> save_buffer;
+static thread_local size_t save_position;    // next byte read from save_buffer
+static thread_local bool save_read_past_end; // a read ran off the end of save_buffer
+static thread_local bool save_buffered;      // use save_buffer rather than fileptr
+static thread_local int save_format;
+static thread_local size_t section_length_at; // where wrSectionEnd() puts the length
+static thread_local size_t section_end;       // where rdSectionEnd() expects to be
+
+// Added to the saved player and monster speeds, so an autosave can leave out
+// the pack weight penalty without changing the game, see saveChar().
+static thread_local int save_speed_adjustment;
+
+// The autosave being written in the background, see autosaveGame()
+static thread_local std::future<bool> autosave_writer;
 
 // This save package was brought to by                -JWT-
 // and                                                -RAK-
@@ -85,13 +136,7 @@ bool saveGame() {
     return true;
 }
 
-static bool svWrite() {
-    // clear the game.character_is_dead flag when creating a HANGUP save file,
-    // so that player can see tombstone when restart
-    if (eof_flag != 0) {
-        game.character_is_dead = false;
-    }
-
+static void svWrite() {
     uint32_t l = 0;
 
     if (config::options::run_cut_corners) {
@@ -127,6 +172,12 @@ static bool svWrite() {
     if (config::options::display_counts) {
         l |= 0x400;
     }
+    if (config::options::monster_pathing) {
+        l |= 0x800;
+    }
+    if (config::options::fast_dice_rolls) {
+        l |= 0x1000;
+    }
     if (game.character_is_dead) {
         // Sign bit
         l |= 0x80000000L;
@@ -135,6 +186,8 @@ static bool svWrite() {
         l |= 0x40000000L;
     }
 
+    wrSectionStart(SAVE_SECTION_RECALL);
+
     for (int i = 0; i < MON_MAX_CREATURES; i++) {
         Recall_t &r = creature_recall[i];
         if (r.movement || r.defenses || r.kills || r.spells || r.deaths || r.attacks[0] || r.attacks[1] || r.attacks[2] || r.attacks[3]) {
@@ -153,9 +206,12 @@ static bool svWrite() {
     // sentinel to indicate no more monster info
     wrShort((uint16_t) 0xFFFF);
 
+    wrSectionEnd();
+    wrSectionStart(SAVE_SECTION_CHARACTER);
+
     wrLong(l);
 
-    wrString(py.misc.name);
+    wrString(py.misc.name, sizeof(py.misc.name));
     wrBool(py.misc.gender);
     wrLong((uint32_t) py.misc.au);
     wrLong((uint32_t) py.misc.max_exp);
@@ -193,7 +249,7 @@ static bool svWrite() {
     wrShort((uint16_t) py.misc.current_hp);
     wrShort(py.misc.current_hp_fraction);
     for (auto &entry : py.misc.history) {
-        wrString(entry);
+        wrString(entry, sizeof(entry));
     }
 
     wrBytes(py.stats.max, 6);
@@ -209,7 +265,7 @@ static bool svWrite() {
     wrShort((uint16_t) py.flags.food);
     wrShort((uint16_t) py.flags.food_digested);
     wrShort((uint16_t) py.flags.protection);
-    wrShort((uint16_t) py.flags.speed);
+    wrShort((uint16_t) (py.flags.speed + save_speed_adjustment));
     wrShort((uint16_t) py.flags.fast);
     wrShort((uint16_t) py.flags.slow);
     wrShort((uint16_t) py.flags.afraid);
@@ -266,7 +322,7 @@ static bool svWrite() {
     wrLong(game.town_seed);
     wrShort((uint16_t) last_message_id);
     for (auto &message : messages) {
-        wrString(message);
+        wrString(message, sizeof(message));
     }
 
     // this indicates 'cheating' if it is a one
@@ -275,6 +331,9 @@ static bool svWrite() {
     wrShort((uint16_t) game.noscore);
     wrShorts(py.base_hp_levels, PLAYER_MAX_LEVEL);
 
+    wrSectionEnd();
+    wrSectionStart(SAVE_SECTION_STORES);
+
     for (auto &store : stores) {
         wrLong((uint32_t) store.turns_left_before_closing);
         wrShort((uint16_t) store.insults_counter);
@@ -288,6 +347,9 @@ static bool svWrite() {
         }
     }
 
+    wrSectionEnd();
+    wrSectionStart(SAVE_SECTION_SUMMARY);
+
     // save the current time in the save file
     l = getCurrentUnixTime();
 
@@ -299,7 +361,7 @@ static bool svWrite() {
     wrLong(l);
 
     // put game.character_died_from string in save file
-    wrString(game.character_died_from);
+    wrString(game.character_died_from, sizeof(game.character_died_from));
 
     // put the max_score in the save file
     l = (uint32_t) (playerCalculateTotalPoints());
@@ -308,12 +370,16 @@ static bool svWrite() {
     // put the date_of_birth in the save file
     wrLong((uint32_t) py.misc.date_of_birth);
 
+    wrSectionEnd();
+
     // only level specific info follows, this allows characters to be
     // resurrected, the dungeon level info is not needed for a resurrection
     if (game.character_is_dead) {
-        return !((ferror(fileptr) != 0) || fflush(fileptr) == EOF);
+        return;
     }
 
+    wrSectionStart(SAVE_SECTION_LEVEL);
+
     wrShort((uint16_t) dg.current_level);
     wrShort((uint16_t) py.pos.y);
     wrShort((uint16_t) py.pos.x);
@@ -323,12 +389,16 @@ static bool svWrite() {
     wrShort((uint16_t) dg.panel.max_rows);
     wrShort((uint16_t) dg.panel.max_cols);
 
+    // The monster and treasure lists are saved without the free ids in their
+    // pools, so each id is saved as its position in the pool.
+
     for (int i = 0; i < MAX_HEIGHT; i++) {
         for (int j = 0; j < MAX_WIDTH; j++) {
-            if (dg.floor[i][j].creature_id != 0) {
+            int id = dg.floor[i][j].creature_id;
+            if (id != 0) {
                 wrByte((uint8_t) i);
                 wrByte((uint8_t) j);
-                wrByte(dg.floor[i][j].creature_id);
+                wrByte((uint8_t) (id == 1 ? id : monster_pool.first + monster_pool.positions[id]));
             }
         }
     }
@@ -336,52 +406,177 @@ static bool svWrite() {
     // marks end of creature_id info
     wrByte((uint8_t) 0xFF);
 
-    for (int i = 0; i < MAX_HEIGHT; i++) {
-        for (int j = 0; j < MAX_WIDTH; j++) {
-            if (dg.floor[i][j].treasure_id != 0) {
-                wrByte((uint8_t) i);
-                wrByte((uint8_t) j);
-                wrByte(dg.floor[i][j].treasure_id);
-            }
+    for (int position = 0; position < game.treasure.pool.used; position++) {
+        Coord_t coord = Coord_t{0, 0};
+        if (dungeonTreasureIsAt(game.treasure.pool.ids[position], coord)) {
+            wrByte((uint8_t) coord.y);
+            wrByte((uint8_t) coord.x);
+            wrByte((uint8_t) (game.treasure.pool.first + position));
         }
     }
 
     // marks end of treasure_id info
     wrByte((uint8_t) 0xFF);
 
-    // must set counter to zero, note that code may write out two bytes unnecessarily
-    int count = 0;
-    uint8_t prev_char = 0;
+    // One byte per tile, the feature in the low nibble and the flags above it
+    uint8_t row[MAX_WIDTH];
 
-    for (auto &row : dg.floor) {
-        for (auto tile : row) {
-            auto char_tmp = (uint8_t) (tile.feature_id | (tile.perma_lit_room << 4) | (tile.field_mark << 5) | (tile.permanent_light << 6) | (tile.temporary_light << 7));
+    for (int y = 0; y < MAX_HEIGHT; y++) {
+        const uint8_t *feature_ids = dg.floor.feature_ids[y];
+        const uint8_t *flags = dg.floor.flags[y];
 
-            if (char_tmp != prev_char || count == UCHAR_MAX) {
-                wrByte((uint8_t) count);
-                wrByte(prev_char);
-                prev_char = char_tmp;
-                count = 1;
-            } else {
-                count++;
-            }
+        for (int x = 0; x < MAX_WIDTH; x++) {
+            row[x] = (uint8_t) (feature_ids[x] | (flags[x] << 4));
         }
+        wrBytes(row, MAX_WIDTH);
+    }
+
+    wrSectionEnd();
+    wrSectionStart(SAVE_SECTION_TREASURE);
+
+    wrShort((uint16_t) (game.treasure.pool.first + game.treasure.pool.used));
+    for (int position = 0; position < game.treasure.pool.used; position++) {
+        wrItem(game.treasure.list[game.treasure.pool.ids[position]]);
     }
 
-    // save last entry
-    wrByte((uint8_t) count);
-    wrByte(prev_char);
+    wrSectionEnd();
+    wrSectionStart(SAVE_SECTION_MONSTERS);
+
+    wrShort((uint16_t) (monster_pool.first + monster_pool.used));
+    for (int position = 0; position < monster_pool.used; position++) {
+        wrMonster(monsters[monster_pool.ids[position]]);
+    }
+
+    wrSectionEnd();
+}
+
+#ifdef _WIN32
+#define fsync _commit
+#endif
+
+// Puts the `temporary` file in place of `filename` in one step. When `backup`
+// is set, the old save file is kept as `filename` + ".bak" first.
+static bool saveFileReplace(const std::string &temporary, const std::string &filename, bool backup) {
+    if (backup && access(filename.c_str(), 0) == 0) {
+        std::string backup_filename = filename + ".bak";
+        (void) unlink(backup_filename.c_str());
+
+        // Losing the backup is better than losing the save, so carry on anyway
+#ifdef _WIN32
+        (void) CopyFileA(filename.c_str(), backup_filename.c_str(), FALSE);
+#else
+        (void) link(filename.c_str(), backup_filename.c_str());
+#endif
+    }
+
+#ifdef _WIN32
+    return MoveFileExA(temporary.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(temporary.c_str(), filename.c_str()) != 0) {
+        return false;
+    }
+
+    // Make the rename itself durable
+    size_t slash = filename.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : filename.substr(0, slash + 1);
+
+    int fd = open(directory.c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+        (void) fsync(fd);
+        (void) close(fd);
+    }
+
+    return true;
+#endif
+}
+
+// Writes the `data` of a save file to a temporary file next to `filename`,
+// which then takes the place of the old one, so a crash or a full disk part
+// way through a save never loses the previous save. `created` is set when the
+// temporary file could be made.
+// Only touches the arguments, so it can run on another thread.
+static bool saveFileWrite(const std::string &filename, const std::vector<uint8_t> &data, bool backup, bool &created) {
+    std::string temporary = filename + ".tmp";
+
+    // Left behind by a save which failed
+    (void) unlink(temporary.c_str());
+
+    int fd = open(temporary.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    created = fd >= 0;
+    if (!created) {
+        return false;
+    }
+    (void) close(fd);
+
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        (void) unlink(temporary.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+
+    // Make sure the data is on the disk before the file is renamed
+    if (fflush(file) == EOF || fsync(fileno(file)) != 0) {
+        ok = false;
+    }
+    if (fclose(file) == EOF) {
+        ok = false;
+    }
 
-    wrShort((uint16_t) game.treasure.current_id);
-    for (int i = config::treasure::MIN_TREASURE_LIST_ID; i < game.treasure.current_id; i++) {
-        wrItem(game.treasure.list[i]);
+    if (ok) {
+        ok = saveFileReplace(temporary, filename, backup);
     }
-    wrShort((uint16_t) next_free_monster_id);
-    for (int i = config::monsters::MON_MIN_INDEX_ID; i < next_free_monster_id; i++) {
-        wrMonster(monsters[i]);
+    if (!ok) {
+        (void) unlink(temporary.c_str());
     }
 
-    return !((ferror(fileptr) != 0) || fflush(fileptr) == EOF);
+    return ok;
+}
+
+// An existing file is only replaced when the game was restored from it,
+// or the wizard says so.
+static bool saveFileWritable(const std::string &filename, bool ask_wizard) {
+    return access(filename.c_str(), 0) < 0 || from_save_file != 0 || (ask_wizard && game.wizard_mode && getInputConfirmation("Can't make new save file. Overwrite old?"));
+}
+
+// Builds the whole save file in `save_buffer`.
+static void svEncode(int speed_adjustment) {
+    save_buffer.clear();
+    save_buffered = true;
+    save_format = SAVE_FORMAT_V2;
+    save_speed_adjustment = speed_adjustment;
+
+    wrBytes(SAVE_V2_MAGIC, sizeof(SAVE_V2_MAGIC));
+    wrByte(CURRENT_VERSION_MAJOR);
+    wrByte(CURRENT_VERSION_MINOR);
+    wrByte(CURRENT_VERSION_PATCH);
+
+    svWrite();
+
+    save_buffered = false;
+}
+
+// A 64-bit FNV-1a hash of the whole game, as it would be saved. Nothing about
+// the game is changed, the pack weight penalty is left out as when saving.
+uint64_t saveStateHash() {
+    svEncode(-py.pack.heaviness);
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto byte : save_buffer) {
+        hash = (hash ^ byte) * 1099511628211ULL;
+    }
+    save_buffer.clear();
+
+    return hash;
+}
+
+// Waits for an autosave still being written, returns false if it failed.
+static bool autosaveWait() {
+    if (!autosave_writer.valid()) {
+        return true;
+    }
+    return autosave_writer.get();
 }
 
 static bool saveChar(const std::string &filename) {
@@ -389,58 +584,36 @@ static bool saveChar(const std::string &filename) {
         return true; // Nothing to save.
     }
 
+    // The save must land after any autosave
+    (void) autosaveWait();
+
     putQIO();
     playerDisturb(1, 0);                   // Turn off resting and searching.
     playerChangeSpeed(-py.pack.heaviness); // Fix the speed
     py.pack.heaviness = 0;
-    bool ok = false;
-
-    fileptr = nullptr; // Do not assume it has been init'ed
 
-    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
-
-    if (fd < 0 && access(filename.c_str(), 0) >= 0 && ((from_save_file != 0) || (game.wizard_mode && getInputConfirmation("Can't make new save file. Overwrite old?")))) {
-        (void) chmod(filename.c_str(), 0600);
-        fd = open(filename.c_str(), O_RDWR | O_TRUNC, 0600);
+    // clear the game.character_is_dead flag when creating a HANGUP save file,
+    // so that player can see tombstone when restart
+    if (eof_flag != 0) {
+        game.character_is_dead = false;
     }
 
-    if (fd >= 0) {
-        (void) close(fd);
-        fileptr = fopen(config::files::save_game.c_str(), "wb");
-    }
+    bool ok = false;
+    bool created = false;
 
     DEBUG(logfile = fopen("IO_LOG", "a"))
     DEBUG(fprintf(logfile, "Saving data to %s\n", config::files::save_game))
 
-    if (fileptr != nullptr) {
-        xor_byte = 0;
-        wrByte(CURRENT_VERSION_MAJOR);
-        xor_byte = 0;
-        wrByte(CURRENT_VERSION_MINOR);
-        xor_byte = 0;
-        wrByte(CURRENT_VERSION_PATCH);
-        xor_byte = 0;
-
-        auto char_tmp = (uint8_t) (randomNumber(256) - 1);
-        wrByte(char_tmp);
-        // Note that xor_byte is now equal to char_tmp
-
-        ok = svWrite();
-
-        DEBUG(fclose(logfile))
-
-        if (fclose(fileptr) == EOF) {
-            ok = false;
-        }
+    if (saveFileWritable(filename, true)) {
+        svEncode(0);
+        ok = saveFileWrite(filename, save_buffer, config::files::save_game_backup, created);
     }
 
-    if (!ok) {
-        if (fd >= 0) {
-            (void) unlink(filename.c_str());
-        }
+    DEBUG(fclose(logfile))
 
+    if (!ok) {
         std::string output;
-        if (fd >= 0) {
+        if (created) {
             output = "Error writing to file '" + filename + "'";
         } else {
             output = "Can't create new file '" + filename + "'";
@@ -456,10 +629,51 @@ static bool saveChar(const std::string &filename) {
     return true;
 }
 
+// Saves the game without stopping play: the save file is built on the game
+// thread, then written out on another. Unlike saveGame() nothing about the
+// game is changed; resting and searching are saved as they are, and only the
+// pack weight penalty is left out of the saved speeds, as saveChar() does.
+// Skipped while the last autosave is still being written.
+void autosaveGame() {
+    if (config::files::autosave_turns == 0 || game.character_is_dead || game.character_saved) {
+        return;
+    }
+
+    if (autosave_writer.valid()) {
+        if (autosave_writer.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+        if (!autosave_writer.get()) {
+            printMessage(("Autosave to '" + config::files::save_game + "' failed.").c_str());
+        }
+    }
+
+    const std::string &filename = config::files::save_game;
+    if (!saveFileWritable(filename, false)) {
+        return;
+    }
+
+    // From now on the save file belongs to this game
+    from_save_file = 1;
+
+    svEncode(-py.pack.heaviness);
+
+    autosave_writer = std::async(std::launch::async, [filename, data = std::move(save_buffer), backup = config::files::save_game_backup]() {
+        bool created;
+        return saveFileWrite(filename, data, backup, created);
+    });
+    save_buffer.clear();
+}
+
+// Waits for the last autosave to be written, before the game ends.
+void autosaveFinish() {
+    if (!autosaveWait()) {
+        std::cerr << "Autosave to '" << config::files::save_game << "' failed.\n";
+    }
+}
+
 // Certain checks are omitted for the wizard. -CJS-
 bool loadGame(bool &generate) {
-    Tile_t *tile = nullptr;
-    int c;
     uint32_t time_saved = 0;
     uint8_t version_maj = 0;
     uint8_t version_min = 0;
@@ -468,6 +682,7 @@ bool loadGame(bool &generate) {
     generate = true;
     int fd = -1;
     int total_count = 0;
+    int next_id = 0;
 
     // Not required for Mac, because the file name is obtained through a dialog.
     // There is no way for a nonexistent file to be specified. -BS-
@@ -508,6 +723,17 @@ bool loadGame(bool &generate) {
         DEBUG(logfile = fopen("IO_LOG", "a"))
         DEBUG(fprintf(logfile, "Reading data from %s\n", config::files::save_game))
 
+        if (!svReadFile()) {
+            goto error;
+        }
+
+        if (save_buffer.size() >= sizeof(SAVE_V2_MAGIC) && memcmp(save_buffer.data(), SAVE_V2_MAGIC, sizeof(SAVE_V2_MAGIC)) == 0) {
+            save_format = SAVE_FORMAT_V2;
+            save_position = sizeof(SAVE_V2_MAGIC);
+        } else {
+            save_format = SAVE_FORMAT_V1;
+        }
+
         // Note: setting these xor_byte is correct!
         xor_byte = 0;
         version_maj = rdByte();
@@ -516,7 +742,9 @@ bool loadGame(bool &generate) {
         xor_byte = 0;
         patch_level = rdByte();
 
-        xor_byte = getByte();
+        if (save_format == SAVE_FORMAT_V1) {
+            xor_byte = getByte();
+        }
 
         if (!validGameVersion(version_maj, version_min, patch_level)) {
             putStringClearToEOL("Sorry. This save file is from a different version of umoria.", Coord_t{2, 0});
@@ -526,6 +754,10 @@ bool loadGame(bool &generate) {
         uint16_t uint_16_t_tmp;
         uint32_t l;
 
+        if (!rdSectionStart(SAVE_SECTION_RECALL)) {
+            goto error;
+        }
+
         uint_16_t_tmp = rdShort();
         while (uint_16_t_tmp != 0xFFFF) {
             if (uint_16_t_tmp >= MON_MAX_CREATURES) {
@@ -543,6 +775,10 @@ bool loadGame(bool &generate) {
             uint_16_t_tmp = rdShort();
         }
 
+        if (!rdSectionEnd() || !rdSectionStart(SAVE_SECTION_CHARACTER)) {
+            goto error;
+        }
+
         l = rdLong();
 
         config::options::run_cut_corners = (l & 0x1) != 0;
@@ -556,6 +792,8 @@ bool loadGame(bool &generate) {
         config::options::run_ignore_doors = (l & 0x100) != 0;
         config::options::error_beep_sound = (l & 0x200) != 0;
         config::options::display_counts = (l & 0x400) != 0;
+        config::options::monster_pathing = (l & 0x800) != 0;
+        config::options::fast_dice_rolls = (l & 0x1000) != 0;
 
         // Don't allow resurrection of game.total_winner characters.  It causes
         // problems because the character level is out of the allowed range.
@@ -567,7 +805,7 @@ bool loadGame(bool &generate) {
         }
 
         if ((l & 0x80000000L) == 0) {
-            rdString(py.misc.name);
+            rdString(py.misc.name, sizeof(py.misc.name));
             py.misc.gender = rdBool();
             py.misc.au = rdLong();
             py.misc.max_exp = rdLong();
@@ -605,7 +843,7 @@ bool loadGame(bool &generate) {
             py.misc.current_hp = rdShort();
             py.misc.current_hp_fraction = rdShort();
             for (auto &entry : py.misc.history) {
-                rdString(entry);
+                rdString(entry, sizeof(entry));
             }
 
             rdBytes(py.stats.max, 6);
@@ -681,7 +919,7 @@ bool loadGame(bool &generate) {
             game.town_seed = rdLong();
             last_message_id = rdShort();
             for (auto &message : messages) {
-                rdString(message);
+                rdString(message, sizeof(message));
             }
 
             uint16_t panic_save_short;
@@ -694,6 +932,10 @@ bool loadGame(bool &generate) {
             game.noscore = rdShort();
             rdShorts(py.base_hp_levels, PLAYER_MAX_LEVEL);
 
+            if (!rdSectionEnd() || !rdSectionStart(SAVE_SECTION_STORES)) {
+                goto error;
+            }
+
             for (auto &store : stores) {
                 store.turns_left_before_closing = rdLong();
                 store.insults_counter = rdShort();
@@ -710,14 +952,21 @@ bool loadGame(bool &generate) {
                 }
             }
 
+            if (!rdSectionEnd() || !rdSectionStart(SAVE_SECTION_SUMMARY)) {
+                goto error;
+            }
+
             time_saved = rdLong();
-            rdString(game.character_died_from);
+            rdString(game.character_died_from, sizeof(game.character_died_from));
             py.max_score = rdLong();
             py.misc.date_of_birth = rdLong();
+
+            if (!rdSectionEnd()) {
+                goto error;
+            }
         }
 
-        c = getc(fileptr);
-        if (c == EOF || ((l & 0x80000000L) != 0)) {
+        if (save_position == save_buffer.size() || ((l & 0x80000000L) != 0)) {
             if ((l & 0x80000000L) == 0) {
                 if (!game.to_be_wizard || dg.game_turn < 0) {
                     goto error;
@@ -753,9 +1002,6 @@ bool loadGame(bool &generate) {
             putQIO();
             goto closefiles;
         }
-        if (ungetc(c, fileptr) == EOF) {
-            goto error;
-        }
 
         putStringClearToEOL("Restoring Character...", Coord_t{0, 0});
         putQIO();
@@ -763,6 +1009,10 @@ bool loadGame(bool &generate) {
         // only level specific info should follow,
         // not present for dead characters
 
+        if (!rdSectionStart(SAVE_SECTION_LEVEL)) {
+            goto error;
+        }
+
         dg.current_level = rdShort();
         py.pos.y = rdShort();
         py.pos.x = rdShort();
@@ -793,51 +1043,81 @@ bool loadGame(bool &generate) {
             ychar = char_tmp;
             xchar = rdByte();
             char_tmp = rdByte();
-            if (xchar > MAX_WIDTH || ychar > MAX_HEIGHT) {
+            if (xchar > MAX_WIDTH || ychar > MAX_HEIGHT || char_tmp >= LEVEL_MAX_OBJECTS) {
                 goto error;
             }
-            dg.floor[ychar][xchar].treasure_id = char_tmp;
+            dungeonSetTreasureId(Coord_t{ychar, xchar}, char_tmp);
             char_tmp = rdByte();
         }
 
         // read in the rest of the cave info
-        tile = &dg.floor[0][0];
-        total_count = 0;
-        while (total_count != MAX_HEIGHT * MAX_WIDTH) {
-            count = rdByte();
-            char_tmp = rdByte();
-            for (int i = count; i > 0; i--) {
-                if (tile > &dg.floor[MAX_HEIGHT - 1][MAX_WIDTH - 1]) {
-                    goto error;
+        if (save_format == SAVE_FORMAT_V2) {
+            for (int y = 0; y < MAX_HEIGHT; y++) {
+                uint8_t *feature_ids = dg.floor.feature_ids[y];
+                uint8_t *flags = dg.floor.flags[y];
+
+                rdBytes(feature_ids, MAX_WIDTH);
+                for (int x = 0; x < MAX_WIDTH; x++) {
+                    flags[x] = (uint8_t) (feature_ids[x] >> 4);
+                    feature_ids[x] &= 0xF;
                 }
-                tile->feature_id = (uint8_t) (char_tmp & 0xF);
-                tile->perma_lit_room = (bool) ((char_tmp >> 4) & 0x1);
-                tile->field_mark = (bool) ((char_tmp >> 5) & 0x1);
-                tile->permanent_light = (bool) ((char_tmp >> 6) & 0x1);
-                tile->temporary_light = (bool) ((char_tmp >> 7) & 0x1);
-                tile++;
             }
-            total_count += count;
+        } else {
+            total_count = 0;
+            while (total_count != MAX_HEIGHT * MAX_WIDTH) {
+                count = rdByte();
+                char_tmp = rdByte();
+                for (int i = count; i > 0; i--) {
+                    int tile_id = total_count + count - i;
+                    if (tile_id >= MAX_HEIGHT * MAX_WIDTH) {
+                        goto error;
+                    }
+                    Tile_t tile = dg.floor[tile_id / MAX_WIDTH][tile_id % MAX_WIDTH];
+                    tile.feature_id = (uint8_t) (char_tmp & 0xF);
+                    tile.perma_lit_room = (bool) ((char_tmp >> 4) & 0x1);
+                    tile.field_mark = (bool) ((char_tmp >> 5) & 0x1);
+                    tile.permanent_light = (bool) ((char_tmp >> 6) & 0x1);
+                    tile.temporary_light = (bool) ((char_tmp >> 7) & 0x1);
+                }
+                total_count += count;
+            }
         }
+        losMapChanged();
+        openFloorInvalidate();
 
-        game.treasure.current_id = rdShort();
-        if (game.treasure.current_id > LEVEL_MAX_OBJECTS) {
+        if (!rdSectionEnd() || !rdSectionStart(SAVE_SECTION_TREASURE)) {
             goto error;
         }
-        for (int i = config::treasure::MIN_TREASURE_LIST_ID; i < game.treasure.current_id; i++) {
-            rdItem(game.treasure.list[i]);
+
+        // The saved ids are allocated again, in order.
+        next_id = rdShort();
+        if (next_id > LEVEL_MAX_OBJECTS) {
+            goto error;
         }
-        next_free_monster_id = rdShort();
-        if (next_free_monster_id > MON_TOTAL_ALLOCATIONS) {
+        idPoolReset(game.treasure.pool, config::treasure::MIN_TREASURE_LIST_ID, LEVEL_MAX_OBJECTS);
+        for (int i = config::treasure::MIN_TREASURE_LIST_ID; i < next_id; i++) {
+            rdItem(game.treasure.list[idPoolAllocate(game.treasure.pool)]);
+        }
+
+        if (!rdSectionEnd() || !rdSectionStart(SAVE_SECTION_MONSTERS)) {
             goto error;
         }
-        for (int i = config::monsters::MON_MIN_INDEX_ID; i < next_free_monster_id; i++) {
-            rdMonster(monsters[i]);
+
+        next_id = rdShort();
+        if (next_id > MON_TOTAL_ALLOCATIONS) {
+            goto error;
+        }
+        idPoolReset(monster_pool, config::monsters::MON_MIN_INDEX_ID, MON_TOTAL_ALLOCATIONS);
+        monsterScheduleReset();
+        for (int i = config::monsters::MON_MIN_INDEX_ID; i < next_id; i++) {
+            int id = idPoolAllocate(monster_pool);
+            rdMonster(monsters[id]);
+            monsterScheduleUpdate(id);
         }
 
         generate = false; // We have restored a cave - no need to generate.
 
-        if (ferror(fileptr) != 0) {
+        if (!rdSectionEnd() || save_read_past_end) {
             goto error;
         }
 
@@ -856,6 +1136,8 @@ bool loadGame(bool &generate) {
 
         DEBUG(fclose(logfile));
 
+        save_buffered = false;
+
         if (fileptr != nullptr) {
             if (fclose(fileptr) < 0) {
                 ok = false;
@@ -933,87 +1215,108 @@ bool loadGame(bool &generate) {
     return false; // not reached
 }
 
+// Reads the whole of the open save file into `save_buffer`.
+static bool svReadFile() {
+    if (fseek(fileptr, 0, SEEK_END) != 0) {
+        return false;
+    }
+
+    long size = ftell(fileptr);
+    if (size < 0 || fseek(fileptr, 0, SEEK_SET) != 0) {
+        return false;
+    }
+
+    save_buffer.resize((size_t) size);
+    save_position = 0;
+    save_read_past_end = false;
+    save_buffered = true;
+
+    return fread(save_buffer.data(), 1, save_buffer.size(), fileptr) == save_buffer.size();
+}
+
+static void putByte(uint8_t value) {
+    if (save_buffered) {
+        save_buffer.push_back(value);
+    } else {
+        (void) putc((int) value, fileptr);
+    }
+}
+
+// Version 2 sections, the length is filled in by wrSectionEnd()
+static void wrSectionStart(SaveSection section) {
+    wrByte((uint8_t) section);
+    section_length_at = save_buffer.size();
+    wrLong(0);
+}
+
+static void wrSectionEnd() {
+    auto length = (uint32_t) (save_buffer.size() - section_length_at - 4);
+
+    for (int i = 0; i < 4; i++) {
+        save_buffer[section_length_at + i] = (uint8_t) (length >> (8 * i));
+    }
+}
+
 static void wrBool(bool value) {
     wrByte((uint8_t) value);
 }
 
 static void wrByte(uint8_t value) {
-    xor_byte ^= value;
-    (void) putc((int) xor_byte, fileptr);
-    DEBUG(fprintf(logfile, "BYTE:  %02X = %d\n", (int) xor_byte, (int) value))
+    if (save_format == SAVE_FORMAT_V1) {
+        xor_byte ^= value;
+        value = xor_byte;
+    }
+    putByte(value);
+    DEBUG(fprintf(logfile, "BYTE:  %02X\n", (int) value))
 }
 
 static void wrShort(uint16_t value) {
-    xor_byte ^= (value & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
-    DEBUG(fprintf(logfile, "SHORT: %02X", (int) xor_byte))
-    xor_byte ^= ((value >> 8) & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
-    DEBUG(fprintf(logfile, " %02X = %d\n", (int) xor_byte, (int) value))
+    wrByte((uint8_t) (value & 0xFF));
+    wrByte((uint8_t) ((value >> 8) & 0xFF));
 }
 
 static void wrLong(uint32_t value) {
-    xor_byte ^= (value & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
-    DEBUG(fprintf(logfile, "LONG:  %02X", (int) xor_byte))
-    xor_byte ^= ((value >> 8) & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
-    DEBUG(fprintf(logfile, " %02X", (int) xor_byte))
-    xor_byte ^= ((value >> 16) & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
-    DEBUG(fprintf(logfile, " %02X", (int) xor_byte))
-    xor_byte ^= ((value >> 24) & 0xFF);
-    (void) putc((int) xor_byte, fileptr);
-    DEBUG(fprintf(logfile, " %02X = %ld\n", (int) xor_byte, (int32_t) value))
+    wrByte((uint8_t) (value & 0xFF));
+    wrByte((uint8_t) ((value >> 8) & 0xFF));
+    wrByte((uint8_t) ((value >> 16) & 0xFF));
+    wrByte((uint8_t) ((value >> 24) & 0xFF));
 }
 
-static void wrBytes(uint8_t *value, int count) {
-    uint8_t *ptr;
+static void wrBytes(const uint8_t *value, int count) {
+    if (save_buffered && save_format == SAVE_FORMAT_V2) {
+        save_buffer.insert(save_buffer.end(), value, value + count);
+        return;
+    }
 
-    DEBUG(fprintf(logfile, "%d BYTES:", count))
-    ptr = value;
     for (int i = 0; i < count; i++) {
-        xor_byte ^= *ptr++;
-        (void) putc((int) xor_byte, fileptr);
-        DEBUG(fprintf(logfile, "  %02X = %d", (int) xor_byte, (int) (ptr[-1])))
+        wrByte(value[i]);
     }
-    DEBUG(fprintf(logfile, "\n"))
 }
 
-static void wrString(char *str) {
-    DEBUG(char *s = str)
-    DEBUG(fprintf(logfile, "STRING:"))
-    while (*str != '\0') {
-        xor_byte ^= *str++;
-        (void) putc((int) xor_byte, fileptr);
-        DEBUG(fprintf(logfile, " %02X", (int) xor_byte))
-    }
-    xor_byte ^= *str;
-    (void) putc((int) xor_byte, fileptr);
-    DEBUG(fprintf(logfile, " %02X = \"%s\"\n", (int) xor_byte, s))
+// Version 2 strings take `size` bytes, padded with '\0'
+static void wrString(const char *str, int size) {
+    int length = 0;
+    while (length < size - 1 && str[length] != '\0') {
+        length++;
+    }
+
+    wrBytes((const uint8_t *) str, length);
+    for (int i = length; i < size; i++) {
+        wrByte(0);
+    }
 }
 
 static void wrShorts(uint16_t *value, int count) {
-    DEBUG(fprintf(logfile, "%d SHORTS:", count))
-
-    uint16_t *sptr = value;
-
     for (int i = 0; i < count; i++) {
-        xor_byte ^= (*sptr & 0xFF);
-        (void) putc((int) xor_byte, fileptr);
-        DEBUG(fprintf(logfile, "  %02X", (int) xor_byte))
-        xor_byte ^= ((*sptr++ >> 8) & 0xFF);
-        (void) putc((int) xor_byte, fileptr);
-        DEBUG(fprintf(logfile, " %02X = %d", (int) xor_byte, (int) sptr[-1]))
-    }
-    DEBUG(fprintf(logfile, "\n"))
+        wrShort(value[i]);
+    }
 }
 
 static void wrItem(Inventory_t &item) {
     DEBUG(fprintf(logfile, "ITEM:\n"))
     wrShort(item.id);
     wrByte(item.special_name_id);
-    wrString(item.inscription);
+    wrString(item.inscription, sizeof(item.inscription));
     wrLong(item.flags);
     wrByte(item.category_id);
     wrByte(item.sprite);
@@ -1036,7 +1339,7 @@ static void wrMonster(Monster_t const &monster) {
     DEBUG(fprintf(logfile, "MONSTER:\n"))
     wrShort((uint16_t) monster.hp);
     wrShort((uint16_t) monster.sleep_count);
-    wrShort((uint16_t) monster.speed);
+    wrShort((uint16_t) (monster.speed + save_speed_adjustment));
     wrShort(monster.creature_id);
     wrByte((uint8_t) monster.pos.y);
     wrByte((uint8_t) monster.pos.x);
@@ -1048,7 +1351,34 @@ static void wrMonster(Monster_t const &monster) {
 
 // get_byte reads a single byte from a file, without any xor_byte encryption
 static uint8_t getByte() {
-    return (uint8_t) (getc(fileptr) & 0xFF);
+    if (!save_buffered) {
+        return (uint8_t) (getc(fileptr) & 0xFF);
+    }
+
+    if (save_position >= save_buffer.size()) {
+        save_read_past_end = true;
+        return 0;
+    }
+    return save_buffer[save_position++];
+}
+
+// Checks a version 2 file has `section` next
+static bool rdSectionStart(SaveSection section) {
+    if (save_format != SAVE_FORMAT_V2) {
+        return true;
+    }
+
+    if (rdByte() != section) {
+        return false;
+    }
+
+    section_end = save_position + rdLong();
+    return section_end <= save_buffer.size();
+}
+
+// Checks all of a version 2 section was read
+static bool rdSectionEnd() {
+    return save_format != SAVE_FORMAT_V2 || save_position == section_end;
 }
 
 static bool rdBool() {
@@ -1057,88 +1387,80 @@ static bool rdBool() {
 
 static uint8_t rdByte() {
     auto c = getByte();
+    DEBUG(fprintf(logfile, "BYTE:  %02X\n", (int) c))
+
+    if (save_format == SAVE_FORMAT_V2) {
+        return c;
+    }
+
     uint8_t decoded_byte = c ^ xor_byte;
     xor_byte = c;
 
-    DEBUG(fprintf(logfile, "BYTE:  %02X = %d\n", (int) c, decoded_byte))
-
     return decoded_byte;
 }
 
 static uint16_t rdShort() {
-    auto c = getByte();
-    uint16_t decoded_int = c ^ xor_byte;
-
-    xor_byte = getByte();
-    decoded_int |= (uint16_t) (c ^ xor_byte) << 8;
-
-    DEBUG(fprintf(logfile, "SHORT: %02X %02X = %d\n", (int) c, (int) xor_byte, decoded_int))
+    uint16_t decoded_int = rdByte();
+    decoded_int |= (uint16_t) (rdByte() << 8);
 
     return decoded_int;
 }
 
 static uint32_t rdLong() {
-    auto c = getByte();
-    uint32_t decoded_long = c ^ xor_byte;
-
-    xor_byte = getByte();
-    decoded_long |= (uint32_t) (c ^ xor_byte) << 8;
-    DEBUG(fprintf(logfile, "LONG:  %02X %02X ", (int) c, (int) xor_byte))
-
-    c = getByte();
-    decoded_long |= (uint32_t) (c ^ xor_byte) << 16;
-
-    xor_byte = getByte();
-    decoded_long |= (uint32_t) (c ^ xor_byte) << 24;
-    DEBUG(fprintf(logfile, "%02X %02X = %ld\n", (int) c, (int) xor_byte, decoded_long))
+    uint32_t decoded_long = rdByte();
+    decoded_long |= (uint32_t) rdByte() << 8;
+    decoded_long |= (uint32_t) rdByte() << 16;
+    decoded_long |= (uint32_t) rdByte() << 24;
 
     return decoded_long;
 }
 
 static void rdBytes(uint8_t *value, int count) {
-    DEBUG(fprintf(logfile, "%d BYTES:", count))
-    uint8_t *ptr = value;
+    if (save_buffered && save_format == SAVE_FORMAT_V2) {
+        if (save_position + count > save_buffer.size()) {
+            save_read_past_end = true;
+            (void) memset(value, 0, (size_t) count);
+            return;
+        }
+        (void) memcpy(value, &save_buffer[save_position], (size_t) count);
+        save_position += count;
+        return;
+    }
+
     for (int i = 0; i < count; i++) {
-        auto c = getByte();
-        *ptr++ = c ^ xor_byte;
-        xor_byte = c;
-        DEBUG(fprintf(logfile, "  %02X = %d", (int) c, (int) ptr[-1]))
+        value[i] = rdByte();
     }
-    DEBUG(fprintf(logfile, "\n"))
 }
 
-static void rdString(char *str) {
-    DEBUG(char *s = str)
-    DEBUG(fprintf(logfile, "STRING: "))
-    do {
-        auto c = getByte();
-        *str = c ^ xor_byte;
-        xor_byte = c;
-        DEBUG(fprintf(logfile, "%02X ", (int) c))
-    } while (*str++ != '\0');
-    DEBUG(fprintf(logfile, "= \"%s\"\n", s))
+// Version 1 strings end at their '\0', version 2 strings take `size` bytes.
+// Either way, no more than `size` bytes are kept.
+static void rdString(char *str, int size) {
+    if (save_format == SAVE_FORMAT_V2) {
+        rdBytes((uint8_t *) str, size);
+    } else {
+        int length = 0;
+        char c;
+        do {
+            c = (char) rdByte();
+            if (length < size) {
+                str[length++] = c;
+            }
+        } while (c != '\0');
+    }
+    str[size - 1] = '\0';
 }
 
 static void rdShorts(uint16_t *value, int count) {
-    DEBUG(fprintf(logfile, "%d SHORTS:", count))
-    uint16_t *sptr = value;
-
     for (int i = 0; i < count; i++) {
-        auto c = getByte();
-        uint16_t s = c ^ xor_byte;
-        xor_byte = getByte();
-        s |= (uint16_t) (c ^ xor_byte) << 8;
-        *sptr++ = s;
-        DEBUG(fprintf(logfile, "  %02X %02X = %d", (int) c, (int) xor_byte, (int) s))
-    }
-    DEBUG(fprintf(logfile, "\n"))
+        value[i] = rdShort();
+    }
 }
 
 static void rdItem(Inventory_t &item) {
     DEBUG(fprintf(logfile, "ITEM:\n"))
     item.id = rdShort();
     item.special_name_id = rdByte();
-    rdString(item.inscription);
+    rdString(item.inscription, sizeof(item.inscription));
     item.flags = rdLong();
     item.category_id = rdByte();
     item.sprite = rdByte();
@@ -1176,6 +1498,8 @@ static void rdMonster(Monster_t &monster) {
 // set the local fileptr to the score file fileptr
 void setFileptr(FILE *file) {
     fileptr = file;
+    save_buffered = false;
+    save_format = SAVE_FORMAT_V1;
 }
 
 void saveHighScore(HighScore_t const &score) {
@@ -0,0 +1,388 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Headless simulations: many games played at once by a simple automated player
+
+#include "headers.h"
+
+// Games are stopped once they have lasted this many turns, and just in case
+// the automated player gets stuck in some menu, after this many commands.
+constexpr int32_t SIMULATION_MAX_TURNS = 100000;
+constexpr uint32_t SIMULATION_MAX_COMMANDS = 200000;
+
+// Commands the automated player gives in one game turn before it
+// gives up on them and steps in a random direction instead.
+constexpr uint32_t AUTO_PLAYER_MAX_STALLED_COMMANDS = 4;
+
+// Human warrior named "Sim", with the first rolled stats.
+static const char *simulation_character_keys = " am\033aSim\r ";
+
+// SimulationResult_t is the summary of a single simulated game
+typedef struct {
+    uint32_t seed;
+    uint16_t max_depth;  // Deepest level reached
+    int16_t depth;       // Level the game ended on
+    int32_t turns;       // Game turns played
+    uint16_t level;      // Character level
+    bool died;           // False when the game was stopped by the turn/command limits
+    vtype_t died_from;   // Cause of death
+    double milliseconds; // Wall time
+} SimulationResult_t;
+
+// AutoPlayer_t holds the state of the automated player
+typedef struct {
+    uint32_t rng;      // Private RNG so the game RNG sequence is left untouched
+    uint32_t commands; // Commands given so far
+    int32_t turn;      // Game turn of the last command
+    uint32_t stalled;  // Commands given before this one in the same game turn, which took no time
+} AutoPlayer_t;
+
+static thread_local AutoPlayer_t auto_player = {1, 0, -1, 0};
+
+// AutoPlayerSearch_t is the breadth-first search autoPlayerStepToFood() makes
+// over the floor: the first step to reach each tile, as `(dy + 1) * 3 + dx + 1`
+// plus one, 0 for the tiles not reached yet, and the queue of tiles to search from.
+typedef struct {
+    uint8_t first_step[MAX_HEIGHT][MAX_WIDTH];
+    Coord_t queue[MAX_HEIGHT * MAX_WIDTH];
+} AutoPlayerSearch_t;
+
+static thread_local AutoPlayerSearch_t auto_player_search;
+
+// Roguelike direction keys, indexed by `dy + 1` and `dx + 1`.
+static const char auto_player_directions[3][3] = {
+    {'y', 'k', 'u'},
+    {'h', '.', 'l'},
+    {'b', 'j', 'n'},
+};
+
+// xorshift32
+static uint32_t autoPlayerRandom(uint32_t max) {
+    auto_player.rng ^= auto_player.rng << 13;
+    auto_player.rng ^= auto_player.rng >> 17;
+    auto_player.rng ^= auto_player.rng << 5;
+    return auto_player.rng % max;
+}
+
+static int sign(int value) {
+    return (value > 0) - (value < 0);
+}
+
+static bool autoPlayerTileIsDownStairs(Tile_t const &tile) {
+    return tile.treasure_id != 0 && game.treasure.list[tile.treasure_id].category_id == TV_DOWN_STAIR;
+}
+
+// Finds food in the pack, returning the item key to eat it.
+static char autoPlayerFood() {
+    int item_pos_start, item_pos_end;
+    if (!inventoryFindRange(TV_FOOD, TV_NEVER, item_pos_start, item_pos_end)) {
+        return 0;
+    }
+    return (char) ('a' + item_pos_start);
+}
+
+// Finds a light in the pack which has not burnt out, returning the item key
+// to wield it, when the player's own light has.
+static char autoPlayerFreshLight() {
+    if (py.inventory[PlayerEquipment::Light].misc_use > 0) {
+        return 0;
+    }
+
+    for (int item_id = 0; item_id < py.pack.unique_items; item_id++) {
+        if (py.inventory[item_id].category_id == TV_LIGHT && py.inventory[item_id].misc_use > 0) {
+            return (char) ('a' + item_id);
+        }
+    }
+    return 0;
+}
+
+static char autoPlayerRandomDirection() {
+    int dy, dx;
+    do {
+        dy = (int) autoPlayerRandom(3) - 1;
+        dx = (int) autoPlayerRandom(3) - 1;
+    } while (dy == 0 && dx == 0);
+
+    return auto_player_directions[dy + 1][dx + 1];
+}
+
+static uint8_t autoPlayerTileCategory(Tile_t const &tile) {
+    return tile.treasure_id == 0 ? (uint8_t) 0 : game.treasure.list[tile.treasure_id].category_id;
+}
+
+// Open floor, or a door or rubble the player can get through.
+static bool autoPlayerTileIsPassable(Tile_t const &tile) {
+    uint8_t category_id = autoPlayerTileCategory(tile);
+    return tile.feature_id <= MAX_OPEN_SPACE || category_id == TV_CLOSED_DOOR || category_id == TV_SECRET_DOOR || category_id == TV_RUBBLE;
+}
+
+// Finds the nearest food lying on the floor, or else the nearest staircase to a
+// new level, seen or not, and sets `step` to the first step on the shortest
+// walk to it, through doors, secret or not, and rubble. Returns false when
+// there is none.
+static bool autoPlayerStepToFood(Coord_t &step) {
+    AutoPlayerSearch_t &search = auto_player_search;
+    memset(search.first_step, 0, sizeof(search.first_step));
+
+    int head = 0;
+    int tail = 0;
+    search.queue[tail++] = py.pos;
+    search.first_step[py.pos.y][py.pos.x] = 5;
+
+    while (head < tail) {
+        Coord_t from = search.queue[head++];
+
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                Coord_t to = Coord_t{from.y + dy, from.x + dx};
+                if (!coordInBounds(to) || search.first_step[to.y][to.x] != 0 || !autoPlayerTileIsPassable(dg.floor[to.y][to.x])) {
+                    continue;
+                }
+
+                uint8_t first_step = search.first_step[from.y][from.x];
+                if (from.y == py.pos.y && from.x == py.pos.x) {
+                    first_step = (uint8_t) ((dy + 1) * 3 + dx + 2);
+                }
+
+                uint8_t category_id = autoPlayerTileCategory(dg.floor[to.y][to.x]);
+                if (category_id == TV_FOOD || category_id == TV_UP_STAIR || category_id == TV_DOWN_STAIR) {
+                    step = Coord_t{(first_step - 1) / 3 - 1, (first_step - 1) % 3 - 1};
+                    return true;
+                }
+
+                search.first_step[to.y][to.x] = first_step;
+                search.queue[tail++] = to;
+            }
+        }
+    }
+
+    return false;
+}
+
+// The command to take a step: search for a secret door, open or bash a closed
+// door, dig through rubble, or else walk.
+static std::string autoPlayerStepCommand(Coord_t const &step) {
+    char direction = auto_player_directions[step.y + 1][step.x + 1];
+
+    Coord_t coord = Coord_t{py.pos.y + step.y, py.pos.x + step.x};
+    Tile_t const &tile = dg.floor[coord.y][coord.x];
+
+    switch (autoPlayerTileCategory(tile)) {
+        case TV_SECRET_DOOR:
+            return "s";
+        case TV_CLOSED_DOOR:
+            // A stuck door has to be bashed open
+            if (game.treasure.list[tile.treasure_id].misc_use < 0) {
+                return std::string("f") + direction;
+            }
+            return std::string("o") + direction;
+        case TV_RUBBLE:
+            return std::string(1, (char) CTRL_KEY(direction));
+        default:
+            return std::string(1, direction);
+    }
+}
+
+// Finds a monster next to the player, returning the direction key to attack it.
+static char autoPlayerAdjacentMonster() {
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            Coord_t coord = Coord_t{py.pos.y + dy, py.pos.x + dx};
+            if ((dy == 0 && dx == 0) || !coordInBounds(coord) || dg.floor[coord.y][coord.x].creature_id < 2) {
+                continue;
+            }
+
+            // The player can't attack unseen monsters in the walls, see playerMove()
+            if (monsters[dg.floor[coord.y][coord.x].creature_id].lit || dg.floor[coord.y][coord.x].feature_id < MIN_CLOSED_SPACE) {
+                return auto_player_directions[dy + 1][dx + 1];
+            }
+        }
+    }
+    return 0;
+}
+
+// Finds the nearest down staircase the player knows of, returning
+// the direction key of a step towards it.
+static char autoPlayerStepToStairs() {
+    Coord_t stairs = Coord_t{0, 0};
+    int best_distance = INT_MAX;
+
+    for (int y = 0; y < dg.height; y++) {
+        for (int x = 0; x < dg.width; x++) {
+            Tile_t const &tile = dg.floor[y][x];
+            if ((tile.field_mark || tile.permanent_light) && autoPlayerTileIsDownStairs(tile)) {
+                int distance = std::max(std::abs(y - py.pos.y), std::abs(x - py.pos.x));
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    stairs = Coord_t{y, x};
+                }
+            }
+        }
+    }
+
+    if (best_distance == INT_MAX) {
+        return 0;
+    }
+
+    int dy = sign(stairs.y - py.pos.y);
+    int dx = sign(stairs.x - py.pos.x);
+
+    if (dg.floor[py.pos.y + dy][py.pos.x + dx].feature_id >= MIN_CLOSED_SPACE) {
+        return 0;
+    }
+
+    return auto_player_directions[dy + 1][dx + 1];
+}
+
+// Picks the next command: eat when hungry, light a torch when in the dark, fight
+// anything adjacent, rest when hurt, take the stairs down, and otherwise head for
+// them or run around at random. With no food it looks for food on the floor or
+// takes the nearest stairs to a new level where there may be some. Eating and
+// lighting a torch are tried once a turn, and when commands keep taking no time
+// it steps in a random direction.
+static std::string autoPlayerCommand() {
+    bool hungry = (py.flags.status & config::player::status::PY_HUNGRY) != 0u;
+
+    if (auto_player.stalled == 0) {
+        char food = hungry ? autoPlayerFood() : (char) 0;
+        if (food != 0) {
+            return std::string("E") + food;
+        }
+
+        char light = autoPlayerFreshLight();
+        if (light != 0) {
+            return std::string("w") + light;
+        }
+    }
+
+    if (auto_player.stalled >= AUTO_PLAYER_MAX_STALLED_COMMANDS) {
+        return std::string(1, autoPlayerRandomDirection());
+    }
+
+    char direction = autoPlayerAdjacentMonster();
+    if (direction != 0) {
+        return std::string(1, direction);
+    }
+
+    if (py.misc.current_hp < py.misc.max_hp / 2) {
+        return "R*\r";
+    }
+
+    if (autoPlayerTileIsDownStairs(dg.floor[py.pos.y][py.pos.x])) {
+        return ">";
+    }
+
+    if (hungry) {
+        if (autoPlayerTileCategory(dg.floor[py.pos.y][py.pos.x]) == TV_UP_STAIR) {
+            return "<";
+        }
+
+        Coord_t step = Coord_t{0, 0};
+        if (autoPlayerStepToFood(step)) {
+            return autoPlayerStepCommand(step);
+        }
+    }
+
+    direction = autoPlayerStepToStairs();
+    if (direction != 0 && autoPlayerRandom(4) != 0) {
+        return std::string(1, direction);
+    }
+
+    // Uppercase to run
+    return std::string(1, (char) toupper(autoPlayerRandomDirection()));
+}
+
+// Key queue refill: called every time the game wants a key and none are left.
+// Each command is preceded by an ESCAPE, which dismisses any -more- prompt or
+// menu still waiting, and is ignored at the command prompt.
+static void autoPlayerQueueKeys() {
+    if (game.character_is_dead || dg.game_turn > SIMULATION_MAX_TURNS || auto_player.commands >= SIMULATION_MAX_COMMANDS) {
+        // No more keys, so the game is over.
+        return;
+    }
+
+    if (!game.character_generated) {
+        inputQueueKeys(std::string(1, ESCAPE));
+        return;
+    }
+
+    auto_player.commands++;
+
+    if (dg.game_turn != auto_player.turn) {
+        auto_player.turn = dg.game_turn;
+        auto_player.stalled = 0;
+    } else {
+        auto_player.stalled++;
+    }
+
+    inputQueueKeys(ESCAPE + autoPlayerCommand());
+}
+
+// Plays one game, on its own thread so it gets freshly initialized game state.
+static void simulateGame(uint32_t seed, SimulationResult_t &result) {
+    auto start = std::chrono::steady_clock::now();
+
+    rendererSelect(Renderer::Framebuffer);
+    (void) terminalInitialize();
+
+    auto_player.rng = seed != 0 ? seed : 1;
+    auto_player.commands = 0;
+    auto_player.turn = -1;
+    auto_player.stalled = 0;
+
+    inputSelectQueue(autoPlayerQueueKeys);
+    inputQueueKeys(simulation_character_keys);
+
+    startMoria(seed, true, true);
+
+    result.seed = seed;
+    result.max_depth = py.misc.max_dungeon_depth;
+    result.depth = dg.current_level;
+    result.turns = dg.game_turn;
+    result.level = py.misc.level;
+    result.died = game.character_is_dead;
+    (void) strcpy(result.died_from, game.character_died_from);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.milliseconds = elapsed.count();
+}
+
+// Plays `games` games with consecutive seeds, starting at `first_seed`, spread
+// over `workers` threads. Prints a CSV record to stdout as each game finishes.
+void simulateGames(uint32_t first_seed, int games, int workers) {
+    std::atomic<int> next_game{0};
+    std::mutex output_mutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    printf("seed,max_depth,depth,turns,level,died,died_from,wall_ms\n");
+
+    auto worker = [&]() {
+        for (int game_id = next_game++; game_id < games; game_id = next_game++) {
+            SimulationResult_t result{};
+
+            std::thread game_thread(simulateGame, first_seed + (uint32_t) game_id, std::ref(result));
+            game_thread.join();
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            printf("%u,%d,%d,%d,%d,%d,\"%s\",%.3f\n",
+                   result.seed, result.max_depth, result.depth, result.turns, result.level,
+                   result.died ? 1 : 0, result.died_from, result.milliseconds);
+            (void) fflush(stdout);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; i++) {
+        pool.emplace_back(worker);
+    }
+    for (auto &thread : pool) {
+        thread.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    fprintf(stderr, "%d games in %.3f seconds (%.1f games/second) on %d threads\n",
+            games, elapsed.count(), games / elapsed.count(), workers);
+}
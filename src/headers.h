@@ -31,16 +31,24 @@
 
 // Headers we can use on all supported systems!
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <future>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -51,6 +59,7 @@
 #include "types.h"
 
 #include "character.h"
+#include "rng.h"          // before dice.h
 #include "dice.h"
 #include "ui.h"           // before dungeon.h
 #include "inventory.h"    // before game.h
@@ -63,7 +72,6 @@
 #include "monster.h"
 #include "player.h"
 #include "recall.h"
-#include "rng.h"
 #include "scores.h"
 #include "scrolls.h"
 #include "spells.h"
@@ -150,10 +150,21 @@ bool stringToNumber(const char *str, int &number) {
     return true;
 }
 
+// When set, the game clock stays at this time, so recorded games replay the same.
+static thread_local uint32_t fixed_unix_time = 0;
+
 uint32_t getCurrentUnixTime() {
+    if (fixed_unix_time != 0) {
+        return fixed_unix_time;
+    }
     return static_cast<uint32_t>(time(nullptr));
 }
 
+// Stops the game clock at `unix_time`, or restarts it when 0.
+void setFixedUnixTime(uint32_t unix_time) {
+    fixed_unix_time = unix_time;
+}
+
 void humanDateString(char *day) {
     time_t now = time(nullptr);
     struct tm *datetime = localtime(&now);
@@ -164,3 +175,65 @@ void humanDateString(char *day) {
     strftime(day, 11, "%a %b %e", datetime);
 #endif
 }
+
+// Frees every id in the pool.
+void idPoolReset(IdPool_t &pool, int first, int capacity) {
+    assert(first >= 0 && first <= capacity && capacity <= ID_POOL_MAX_IDS);
+
+    pool.first = (int16_t) first;
+    pool.capacity = (int16_t) capacity;
+    pool.used = 0;
+
+    for (int id = first; id < capacity; id++) {
+        pool.ids[id - first] = (uint8_t) id;
+        pool.positions[id] = (uint8_t) (id - first);
+    }
+}
+
+// Returns a free id, or -1 if they are all in use.
+int idPoolAllocate(IdPool_t &pool) {
+    if (pool.used == pool.capacity - pool.first) {
+        return -1;
+    }
+
+    return pool.ids[pool.used++];
+}
+
+// Swaps the id with the last one in use, which leaves it first in the free ids.
+// Ids not in use, such as 0 or an id released twice, are left alone.
+void idPoolRelease(IdPool_t &pool, int id) {
+    if (!idPoolInUse(pool, id)) {
+        return;
+    }
+
+    int position = pool.positions[id];
+    int last_id = pool.ids[pool.used - 1];
+
+    pool.ids[position] = (uint8_t) last_id;
+    pool.positions[last_id] = (uint8_t) position;
+
+    pool.ids[pool.used - 1] = (uint8_t) id;
+    pool.positions[id] = (uint8_t) (pool.used - 1);
+
+    pool.used--;
+}
+
+// Puts the given free id in use, for pools used as a set of ids.
+void idPoolTake(IdPool_t &pool, int id) {
+    assert(id >= pool.first && id < pool.capacity && !idPoolInUse(pool, id));
+
+    int position = pool.positions[id];
+    int first_free_id = pool.ids[pool.used];
+
+    pool.ids[position] = (uint8_t) first_free_id;
+    pool.positions[first_free_id] = (uint8_t) position;
+
+    pool.ids[pool.used] = (uint8_t) id;
+    pool.positions[id] = (uint8_t) pool.used;
+
+    pool.used++;
+}
+
+bool idPoolInUse(IdPool_t const &pool, int id) {
+    return id >= pool.first && id < pool.capacity && pool.positions[id] < pool.used;
+}
@@ -16,4 +16,11 @@ void insertStringIntoString(char *to_string, const char *from_string, const char
 bool isVowel(char ch);
 bool stringToNumber(const char *str, int &number);
 uint32_t getCurrentUnixTime();
+void setFixedUnixTime(uint32_t unix_time);
 void humanDateString(char *day);
+
+void idPoolReset(IdPool_t &pool, int first, int capacity);
+int idPoolAllocate(IdPool_t &pool);
+void idPoolRelease(IdPool_t &pool, int id);
+void idPoolTake(IdPool_t &pool, int id);
+bool idPoolInUse(IdPool_t const &pool, int id);
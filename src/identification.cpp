@@ -8,10 +8,10 @@
 
 #include "headers.h"
 
-char magic_item_titles[MAX_TITLES][10];
+thread_local char magic_item_titles[MAX_TITLES][10];
 
 // Identified objects flags
-uint8_t objects_identified[OBJECT_IDENT_SIZE];
+thread_local uint8_t objects_identified[OBJECT_IDENT_SIZE];
 
 static const char *objectDescription(char command) {
     // every printing ASCII character is listed here, in the
@@ -230,46 +230,47 @@ void identifyGameObject() {
 void magicInitializeItemNames() {
     int id;
 
-    seedSet(game.magic_seed);
+    // The names are the same for the whole game, from a stream of their own
+    Rng_t names_rng = rngCreate((uint32_t) game.magic_seed);
 
     // The first 3 entries for colors are fixed, (slime & apple juice, water)
     for (int i = 3; i < MAX_COLORS; i++) {
-        id = randomNumber(MAX_COLORS - 3) + 2;
+        id = randomNumber(names_rng, MAX_COLORS - 3) + 2;
         const char *color = colors[i];
         colors[i] = colors[id];
         colors[id] = color;
     }
 
     for (auto &w : woods) {
-        id = randomNumber(MAX_WOODS) - 1;
+        id = randomNumber(names_rng, MAX_WOODS) - 1;
         const char *wood = w;
         w = woods[id];
         woods[id] = wood;
     }
 
     for (auto &m : metals) {
-        id = randomNumber(MAX_METALS) - 1;
+        id = randomNumber(names_rng, MAX_METALS) - 1;
         const char *metal = m;
         m = metals[id];
         metals[id] = metal;
     }
 
     for (auto &r : rocks) {
-        id = randomNumber(MAX_ROCKS) - 1;
+        id = randomNumber(names_rng, MAX_ROCKS) - 1;
         const char *rock = r;
         r = rocks[id];
         rocks[id] = rock;
     }
 
     for (auto &a : amulets) {
-        id = randomNumber(MAX_AMULETS) - 1;
+        id = randomNumber(names_rng, MAX_AMULETS) - 1;
         const char *amulet = a;
         a = amulets[id];
         amulets[id] = amulet;
     }
 
     for (auto &m : mushrooms) {
-        id = randomNumber(MAX_MUSHROOMS) - 1;
+        id = randomNumber(names_rng, MAX_MUSHROOMS) - 1;
         const char *mushroom = m;
         m = mushrooms[id];
         mushrooms[id] = mushroom;
@@ -280,11 +281,11 @@ void magicInitializeItemNames() {
 
     for (auto &item_title : magic_item_titles) {
         title[0] = '\0';
-        k = randomNumber(2) + 1;
+        k = randomNumber(names_rng, 2) + 1;
 
         for (int i = 0; i < k; i++) {
-            for (int s = randomNumber(2); s > 0; s--) {
-                (void) strcat(title, syllables[randomNumber(MAX_SYLLABLES) - 1]);
+            for (int s = randomNumber(names_rng, 2); s > 0; s--) {
+                (void) strcat(title, syllables[randomNumber(names_rng, MAX_SYLLABLES) - 1]);
             }
             if (i < k - 1) {
                 (void) strcat(title, " ");
@@ -300,7 +301,7 @@ void magicInitializeItemNames() {
         (void) strcpy(item_title, title);
     }
 
-    seedResetToOldSeed();
+    rngReseed();
 }
 
 int16_t objectPositionOffset(int category_id, int sub_category_id) {
@@ -75,7 +75,7 @@ constexpr uint8_t MAX_AMULETS = 11;    // Used with amulets
 constexpr uint8_t MAX_TITLES = 45;     // Used with scrolls
 constexpr uint8_t MAX_SYLLABLES = 153; // Used with scrolls
 
-extern uint8_t objects_identified[OBJECT_IDENT_SIZE];
+extern thread_local uint8_t objects_identified[OBJECT_IDENT_SIZE];
 extern const char *special_item_names[SpecialNameIds::SN_ARRAY_SIZE];
 
 // Following are arrays for descriptive pieces
@@ -59,7 +59,7 @@ void inventoryDropItem(int item_id, bool drop_all) {
     Inventory_t &item = py.inventory[item_id];
     game.treasure.list[treasure_id] = item;
 
-    dg.floor[py.pos.y][py.pos.x].treasure_id = (uint8_t) treasure_id;
+    dungeonSetTreasureId(py.pos, treasure_id);
 
     if (item_id >= PlayerEquipment::Wield) {
         playerTakeOff(item_id, -1);
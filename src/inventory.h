@@ -32,7 +32,8 @@ constexpr uint8_t INSCRIP_SIZE = 13;
 // Only damage, ac, and tchar are constant; level could possibly be made
 // constant by changing index instead; all are used rarely.
 //
-// Extra fields x and y for location in dungeon would simplify pusht().
+// The location in the dungeon of each treasure is kept alongside the treasure
+// list, see `game.treasure.positions`.
 //
 // Making inscrip[] a pointer and malloc-ing space does not work, there are
 // two many places where `Inventory_t` are copied, which results in dangling
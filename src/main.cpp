@@ -9,6 +9,7 @@
 #include "version.h"
 
 static bool parseGameSeed(const char *argv, uint32_t &seed);
+static void printUsage();
 
 static const char *usage_instructions = R"(
 Usage:
@@ -19,9 +20,26 @@ SAVEGAME is an optional save game filename (default: game.sav)
 Options:
     -n           Force start of new game
     -r           Enable classic roguelike keys on startup (default: disabled, or save game settings)
+    -f           Fast-forward rests, repeated commands and runs: no delays, screen updated when they stop
+    -H           Headless: draw to an in-memory screen, keys are read from standard input
+    -b           Keep the previous SAVEGAME as SAVEGAME.bak each time the game is saved
+    -a TURNS     Autosave in the background every TURNS game turns, and on each new level
+    -p FILE      Profile each turn, appending a report for every level played to FILE
+    -k FILE      Play the keys in FILE (`-` for standard input), the game ends when they run out
     -d           Display high scores and exit
     -s NUMBER    Game Seed, as a decimal number (max: 2147483647)
 
+    --record FILE
+                 Record a new game to FILE: the seed, the options and every key.
+                 SAVEGAME must not exist yet
+    --replay FILE
+                 Play back the game recorded in FILE headless, and check it ends
+                 the same as when it was recorded (exit status 1 if not)
+    --simulate GAMES
+                 Play GAMES headless games with an automated player, using consecutive
+                 seeds from -s (default: 1), and print a CSV summary of each game
+    -j NUMBER    Number of games to simulate at once (default: one per CPU)
+
     -v           Print version info and exit
     -h           Display this message
 )";
@@ -31,6 +49,11 @@ int main(int argc, char *argv[]) {
     uint32_t seed = 0;
     bool new_game = false;
     bool roguelike_keys = false;
+    bool display_scores = false;
+    int simulate_games = 0;
+    int simulate_workers = 0;
+    const char *record_file = nullptr;
+    const char *replay_file = nullptr;
 
     // call this routine to grab a file pointer to the high score file
     // and prepare things to relinquish setuid privileges
@@ -44,15 +67,10 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    if (!terminalInitialize()) {
-        return 1;
-    }
-
     // check for user interface option
     for (--argc, ++argv; argc > 0 && argv[0][0] == '-'; --argc, ++argv) {
         switch (argv[0][1]) {
             case 'v':
-                terminalRestore();
                 printf("%d.%d.%d\n", CURRENT_VERSION_MAJOR, CURRENT_VERSION_MINOR, CURRENT_VERSION_PATCH);
                 return 0;
             case 'n':
@@ -60,10 +78,118 @@ int main(int argc, char *argv[]) {
                 break;
             case 'r':
                 roguelike_keys = true;
+                break;
+            case 'f':
+                config::options::fast_forward = true;
+                break;
+            case 'H':
+                rendererSelect(Renderer::Framebuffer);
+                break;
+            case 'b':
+                config::files::save_game_backup = true;
+                break;
+            case 'a':
+                // No TURNS provided?
+                if (argv[1] == nullptr) {
+                    break;
+                }
+
+                // Move onto the TURNS value
+                --argc;
+                ++argv;
+
+                if (!stringToNumber(argv[0], config::files::autosave_turns) || config::files::autosave_turns < 1) {
+                    printf("Autosave TURNS must be at least 1\n");
+                    return -1;
+                }
+
+                break;
+            case 'p':
+                // No FILE provided?
+                if (argv[1] == nullptr) {
+                    break;
+                }
+
+                // Move onto the FILE value
+                --argc;
+                ++argv;
+
+                profilerEnable(argv[0]);
+                break;
+            case 'k':
+                // No FILE provided?
+                if (argv[1] == nullptr) {
+                    break;
+                }
+
+                // Move onto the FILE value
+                --argc;
+                ++argv;
+
+                if (!inputSelectFile(argv[0])) {
+                    printf("Can't open key script '%s'\n", argv[0]);
+                    return 1;
+                }
+
                 break;
             case 'd':
-                showScoresScreen();
-                exitProgram();
+                display_scores = true;
+                break;
+            case 'j':
+                // No NUMBER provided?
+                if (argv[1] == nullptr) {
+                    break;
+                }
+
+                // Move onto the NUMBER value
+                --argc;
+                ++argv;
+
+                if (!stringToNumber(argv[0], simulate_workers) || simulate_workers < 1) {
+                    printf("Number of games to simulate at once must be at least 1\n");
+                    return -1;
+                }
+
+                break;
+            case '-':
+                if (argv[1] == nullptr) {
+                    printUsage();
+                    return 0;
+                }
+
+                if (strcmp(argv[0], "--record") == 0) {
+                    // Move onto the FILE value
+                    --argc;
+                    ++argv;
+
+                    record_file = argv[0];
+                    new_game = true;
+                    break;
+                }
+
+                if (strcmp(argv[0], "--replay") == 0) {
+                    // Move onto the FILE value
+                    --argc;
+                    ++argv;
+
+                    replay_file = argv[0];
+                    break;
+                }
+
+                if (strcmp(argv[0], "--simulate") != 0) {
+                    printUsage();
+                    return 0;
+                }
+
+                // Move onto the GAMES value
+                --argc;
+                ++argv;
+
+                if (!stringToNumber(argv[0], simulate_games) || simulate_games < 1) {
+                    printf("Number of games to simulate must be at least 1\n");
+                    return -1;
+                }
+
                 break;
             case 's':
                 // No NUMBER provided?
@@ -76,7 +202,6 @@ int main(int argc, char *argv[]) {
                 ++argv;
 
                 if (!parseGameSeed(argv[0], seed)) {
-                    terminalRestore();
                     printf("Game seed must be a decimal number between 1 and 2147483647\n");
                     return -1;
                 }
@@ -86,23 +211,56 @@ int main(int argc, char *argv[]) {
                 game.to_be_wizard = true;
                 break;
             default:
-                terminalRestore();
-
-                printf("Robert A. Koeneke's classic dungeon crawler.\n");
-                printf("Umoria %d.%d.%d is released under a GPL-3.0-or-later license.\n", CURRENT_VERSION_MAJOR, CURRENT_VERSION_MINOR, CURRENT_VERSION_PATCH);
-                printf("%s", usage_instructions);
+                printUsage();
                 return 0;
         }
     }
 
+    // Simulations never use the terminal
+    if (simulate_games > 0) {
+        if (simulate_workers == 0) {
+            simulate_workers = std::max(1, (int) std::thread::hardware_concurrency());
+        }
+        simulateGames(seed != 0 ? seed : 1, simulate_games, simulate_workers);
+        return 0;
+    }
+
+    // Replays never use the terminal either
+    if (replay_file != nullptr) {
+        return replayPlay(replay_file);
+    }
+
+    // The terminal is set up once the options are known, as they select the renderer.
+    if (!terminalInitialize()) {
+        return 1;
+    }
+
+    if (display_scores) {
+        showScoresScreen();
+        flushInputBuffer();
+        terminalRestore();
+        return 0;
+    }
+
     // Auto-restart of saved file
     if (argv[0] != CNIL) {
         // (void) strcpy(config::files::save_game, argv[0]);
         config::files::save_game = argv[0];
     }
 
+    if (record_file != nullptr && !replayRecordStart(record_file, seed, roguelike_keys)) {
+        terminalRestore();
+        printf("Can't record to '%s', the save game '%s' must not exist yet\n", record_file, config::files::save_game.c_str());
+        return 1;
+    }
+
     startMoria(seed, new_game, roguelike_keys);
 
+    if (record_file != nullptr && !replayRecordFinish()) {
+        printf("Error writing replay file '%s'\n", record_file);
+        return 1;
+    }
+
     return 0;
 }
 
@@ -120,3 +278,9 @@ static bool parseGameSeed(const char *argv, uint32_t &seed) {
 
     return true;
 }
+
+static void printUsage() {
+    printf("Robert A. Koeneke's classic dungeon crawler.\n");
+    printf("Umoria %d.%d.%d is released under a GPL-3.0-or-later license.\n", CURRENT_VERSION_MAJOR, CURRENT_VERSION_MINOR, CURRENT_VERSION_PATCH);
+    printf("%s", usage_instructions);
+}
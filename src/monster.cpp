@@ -7,9 +7,9 @@
 
 #include "headers.h"
 
-// A horrible hack, needed because compactMonsters() is called from deep
-// within updateMonsters() via monsterPlaceNew() and monsterSummon().
-int hack_monptr = -1;
+// A horrible hack, needed because monsterTakeHit() is called from deep
+// within updateMonsters() when a monster is stuck in rock.
+static thread_local int hack_monptr = -1;
 
 static bool executeAttackOnPlayer(uint8_t creature_level, int16_t &monster_hp, int monster_id, int attack_type, int damage, vtype_t death_description, bool noticed);
 
@@ -46,7 +46,7 @@ void monsterUpdateVisibility(int monster_id) {
         if (game.wizard_mode) {
             // Wizard sight.
             visible = true;
-        } else if (los(py.pos, monster.pos)) {
+        } else if (losFromPlayer(monster.pos)) {
             visible = monsterIsVisible(monster);
         }
     }
@@ -474,7 +474,7 @@ static void monsterAttackPlayer(int monster_id) {
     }
 }
 
-static void monsterOpenDoor(Tile_t &tile, int16_t monster_hp, uint32_t move_bits, bool &do_turn, bool &do_move, uint32_t &rcmove, Coord_t coord) {
+static void monsterOpenDoor(Tile_t tile, int16_t monster_hp, uint32_t move_bits, bool &do_turn, bool &do_move, uint32_t &rcmove, Coord_t coord) {
     Inventory_t &item = game.treasure.list[tile.treasure_id];
 
     // Creature can open doors.
@@ -517,6 +517,7 @@ static void monsterOpenDoor(Tile_t &tile, int16_t monster_hp, uint32_t move_bits
                 item.misc_use = (int16_t) (1 - randomNumber(2));
             }
             tile.feature_id = TILE_CORR_FLOOR;
+            losMapChanged();
             dungeonLiteSpot(coord);
             rcmove |= config::monsters::move::CM_OPEN_DOOR;
             do_move = false;
@@ -532,6 +533,7 @@ static void monsterOpenDoor(Tile_t &tile, int16_t monster_hp, uint32_t move_bits
             // 50% chance of breaking door
             item.misc_use = (int16_t) (1 - randomNumber(2));
             tile.feature_id = TILE_CORR_FLOOR;
+            losMapChanged();
             dungeonLiteSpot(coord);
             printMessage("You hear a door burst open!");
             playerDisturb(1, 0);
@@ -579,7 +581,7 @@ static void monsterMovesOnPlayer(Monster_t const &monster, uint8_t creature_id,
             }
 
             // It ate an already processed monster. Handle normally.
-            if (monster_id < creature_id) {
+            if (monsterTurnTaken((int) creature_id, monster_id)) {
                 dungeonDeleteMonster((int) creature_id);
             } else {
                 // If it eats this monster, an already processed
@@ -636,7 +638,7 @@ static void makeMove(int monster_id, int *directions, uint32_t &rcmove) {
 
         (void) playerMovePosition(directions[i], coord);
 
-        Tile_t &tile = dg.floor[coord.y][coord.x];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
         if (tile.feature_id == TILE_BOUNDARY_WALL) {
             continue;
@@ -681,7 +683,7 @@ static bool monsterCanCastSpells(Monster_t const &monster, uint32_t spells) {
     bool within_range = monster.distance_from_player <= config::monsters::MON_MAX_SPELL_CAST_DISTANCE;
 
     // Must have unobstructed Line-Of-Sight
-    bool unobstructed = los(py.pos, monster.pos);
+    bool unobstructed = losFromPlayer(monster.pos);
 
     return within_range && unobstructed;
 }
@@ -758,10 +760,7 @@ void monsterExecuteCastingOfSpell(Monster_t &monster, int monster_id, int spell_
             coord.y = py.pos.y;
             coord.x = py.pos.x;
 
-            // in case compact_monster() is called,it needs monster_id
-            hack_monptr = monster_id;
             (void) monsterSummon(coord, false);
-            hack_monptr = -1;
             monsterUpdateVisibility((int) dg.floor[coord.y][coord.x].creature_id);
             break;
         case 15: // Summon Undead
@@ -770,10 +769,7 @@ void monsterExecuteCastingOfSpell(Monster_t &monster, int monster_id, int spell_
             coord.y = py.pos.y;
             coord.x = py.pos.x;
 
-            // in case compact_monster() is called,it needs monster_id
-            hack_monptr = monster_id;
             (void) monsterSummonUndead(coord);
-            hack_monptr = -1;
             monsterUpdateVisibility((int) dg.floor[coord.y][coord.x].creature_id);
             break;
         case 16: // Slow Person
@@ -939,7 +935,7 @@ bool monsterMultiply(Coord_t coord, int creature_id, int monster_id) {
 
                     if (cannibalistic && experienced) {
                         // It ate an already processed monster. Handle * normally.
-                        if (monster_id < tile.creature_id) {
+                        if (monsterTurnTaken((int) tile.creature_id, monster_id)) {
                             dungeonDeleteMonster((int) tile.creature_id);
                         } else {
                             // If it eats this monster, an already processed
@@ -948,11 +944,8 @@ bool monsterMultiply(Coord_t coord, int creature_id, int monster_id) {
                             dungeonRemoveMonsterFromLevel((int) tile.creature_id);
                         }
 
-                        // in case compact_monster() is called, it needs monster_id.
-                        hack_monptr = monster_id;
                         // Place_monster() may fail if monster list full.
                         bool result = monsterPlaceNew(position, creature_id, false);
-                        hack_monptr = -1;
                         if (!result) {
                             return false;
                         }
@@ -963,11 +956,8 @@ bool monsterMultiply(Coord_t coord, int creature_id, int monster_id) {
                 } else {
                     // All clear,  place a monster
 
-                    // in case compact_monster() is called,it needs monster_id
-                    hack_monptr = monster_id;
                     // Place_monster() may fail if monster list full.
                     bool result = monsterPlaceNew(position, creature_id, false);
-                    hack_monptr = -1;
                     if (!result) {
                         return false;
                     }
@@ -1143,6 +1133,11 @@ static void monsterMoveNormally(int monster_id, uint32_t &rcmove) {
         directions[4] = randomNumber(9);
     } else {
         monsterGetMoveDirection(monster_id, directions);
+
+        // Head around walls rather than straight at the player
+        if (config::options::monster_pathing && (creatures_list[monsters[monster_id].creature_id].movement & config::monsters::move::CM_PHASE) == 0u) {
+            (void) monsterFlowDirections(monsters[monster_id].pos, directions);
+        }
     }
 
     rcmove |= config::monsters::move::CM_MOVE_NORMAL;
@@ -1309,10 +1304,228 @@ static void monsterAttackingUpdate(Monster_t &monster, int monster_id, int moves
     }
 }
 
+// The monster schedule decides which monsters updateMonsters() has to look at
+// on a turn, so the others are not touched at all.
+//
+// Monsters are filed in buckets by how often they get moves: bucket 0 holds
+// those with a positive speed, which move every turn, and bucket `n` those
+// which move on the turns divisible by `n`, having a speed of `2 - n`. Bucket 1
+// holds the even slower ones, which monsterMovementRate() checks every turn.
+//
+// A monster which does not move this turn can only change how it's seen when
+// the player moves, when it's lit, or when it's within MON_MAX_SIGHT of the
+// player, as no monster further away is ever visible. The monsters within
+// sight are kept in `in_view`. While the player stays put, only those, the
+// ones which move this turn, and the `touched` ones which were placed, moved,
+// hurt or sped up since they were last looked at, are processed.
+//
+// Monsters which are due to move are skipped as well while they are dormant,
+// see monsterIsDormant(), as their moves would do nothing at all. When the
+// player moves, the distances of all monsters are refreshed in one quick loop,
+// and only the monsters which are not dormant are processed.
+//
+// The chosen monsters are still processed in monster_pool order, from the last
+// position down, as their turns were taken before the schedule was added.
+constexpr int MONSTER_SCHEDULE_BUCKETS = 16;
+constexpr int MONSTER_SCHEDULE_WORDS = ID_POOL_MAX_IDS / 64;
+
+typedef struct {
+    IdPool_t buckets[MONSTER_SCHEDULE_BUCKETS];
+    uint8_t bucket_of[MON_TOTAL_ALLOCATIONS];
+    IdPool_t in_view;
+    IdPool_t touched;
+    bool player_seen;        // `player` is valid
+    Coord_t player;          // player position at the last full update
+    int pass_position;       // monster_pool position being processed, or -1
+    uint64_t pass_positions[MONSTER_SCHEDULE_WORDS]; // positions to process
+} MonsterSchedule_t;
+
+static thread_local MonsterSchedule_t monster_schedule;
+
+static int monsterScheduleBucket(int16_t speed) {
+    if (speed > 0) {
+        return 0;
+    }
+
+    int period = 2 - speed;
+    if (period < MONSTER_SCHEDULE_BUCKETS) {
+        return period;
+    }
+
+    return 1;
+}
+
+static void monsterScheduleMark(int position) {
+    monster_schedule.pass_positions[position >> 6] |= (uint64_t) 1 << (position & 63);
+}
+
+static void monsterScheduleMarkAll(IdPool_t const &set) {
+    for (int i = 0; i < set.used; i++) {
+        monsterScheduleMark(monster_pool.positions[set.ids[i]]);
+    }
+}
+
+// A dormant monster gets nothing done on its turn: it's not lit, it's too far
+// away to be seen or to notice the player (its area_affect_radius), whether
+// asleep or not, and it's not stuck in rock. So monsterAttackingUpdate() would
+// only find it can't be seen, again.
+static bool monsterIsDormant(Monster_t const &monster) {
+    if (monster.lit || monster.distance_from_player <= config::monsters::MON_MAX_SIGHT) {
+        return false;
+    }
+
+    Creature_t const &creature = creatures_list[monster.creature_id];
+
+    if (monster.distance_from_player <= creature.area_affect_radius) {
+        return false;
+    }
+
+    return (creature.movement & config::monsters::move::CM_PHASE) != 0u || dg.floor[monster.pos.y][monster.pos.x].feature_id < MIN_CAVE_WALL;
+}
+
+static void monsterScheduleMarkAwake(IdPool_t const &set) {
+    for (int i = 0; i < set.used; i++) {
+        int id = set.ids[i];
+
+        if (!monsterIsDormant(monsters[id])) {
+            monsterScheduleMark(monster_pool.positions[id]);
+        }
+    }
+}
+
+// Returns the highest marked position at or below `position`, or -1.
+static int monsterScheduleNextPosition(int position) {
+    while (position >= 0) {
+        uint64_t word = monster_schedule.pass_positions[position >> 6];
+
+        if (word == 0) {
+            position = (position & ~63) - 1;
+            continue;
+        }
+
+        if (((word >> (position & 63)) & 1u) != 0) {
+            return position;
+        }
+        position--;
+    }
+
+    return -1;
+}
+
+// Empties the schedule, must be called whenever the monster list is reset.
+void monsterScheduleReset() {
+    for (auto &bucket : monster_schedule.buckets) {
+        idPoolReset(bucket, config::monsters::MON_MIN_INDEX_ID, MON_TOTAL_ALLOCATIONS);
+    }
+    idPoolReset(monster_schedule.in_view, config::monsters::MON_MIN_INDEX_ID, MON_TOTAL_ALLOCATIONS);
+    idPoolReset(monster_schedule.touched, config::monsters::MON_MIN_INDEX_ID, MON_TOTAL_ALLOCATIONS);
+
+    monster_schedule.player_seen = false;
+    monster_schedule.pass_position = -1;
+}
+
+// Must be called after a monster is placed or changes speed, and whenever it's
+// moved or removed from the level by anything other than its own turn.
+void monsterScheduleUpdate(int monster_id) {
+    int bucket = monsterScheduleBucket(monsters[monster_id].speed);
+
+    if (!idPoolInUse(monster_schedule.buckets[bucket], monster_id)) {
+        int old_bucket = monster_schedule.bucket_of[monster_id];
+        if (idPoolInUse(monster_schedule.buckets[old_bucket], monster_id)) {
+            idPoolRelease(monster_schedule.buckets[old_bucket], monster_id);
+        }
+
+        idPoolTake(monster_schedule.buckets[bucket], monster_id);
+        monster_schedule.bucket_of[monster_id] = (uint8_t) bucket;
+    }
+
+    // Still to be processed by the running updateMonsters(), being processed
+    // right now, or left for the next one, unless it's processed every turn
+    int position = monster_pool.positions[monster_id];
+    if (position < monster_schedule.pass_position) {
+        monsterScheduleMark(position);
+    } else if (position > monster_schedule.pass_position && bucket != 0 && !idPoolInUse(monster_schedule.touched, monster_id)) {
+        idPoolTake(monster_schedule.touched, monster_id);
+    }
+}
+
+// Must be called before the monster's id is released.
+void monsterScheduleRemove(int monster_id) {
+    IdPool_t *sets[] = {&monster_schedule.buckets[monster_schedule.bucket_of[monster_id]], &monster_schedule.in_view, &monster_schedule.touched};
+
+    for (auto set : sets) {
+        if (idPoolInUse(*set, monster_id)) {
+            idPoolRelease(*set, monster_id);
+        }
+    }
+}
+
+// Marks the monsters updateMonsters() has to process this turn.
+static void monsterScheduleStartPass(bool attack) {
+    for (auto &word : monster_schedule.pass_positions) {
+        word = 0;
+    }
+
+    bool player_moved = !monster_schedule.player_seen || monster_schedule.player.y != py.pos.y || monster_schedule.player.x != py.pos.x;
+
+    if (!attack || player_moved) {
+        for (int position = 0; position < monster_pool.used; position++) {
+            Monster_t &monster = monsters[monster_pool.ids[position]];
+            monster.distance_from_player = (uint8_t) coordDistanceBetween(py.pos, monster.pos);
+
+            if (monster.hp < 0 || !monsterIsDormant(monster)) {
+                monsterScheduleMark(position);
+            }
+        }
+
+        monster_schedule.player_seen = true;
+        monster_schedule.player = py.pos;
+    } else {
+        monsterScheduleMarkAwake(monster_schedule.buckets[0]);
+        monsterScheduleMarkAwake(monster_schedule.buckets[1]);
+
+        for (int period = 2; period < MONSTER_SCHEDULE_BUCKETS; period++) {
+            if (dg.game_turn % period == 0) {
+                monsterScheduleMarkAwake(monster_schedule.buckets[period]);
+            }
+        }
+
+        monsterScheduleMarkAll(monster_schedule.in_view);
+        monsterScheduleMarkAll(monster_schedule.touched);
+    }
+
+    while (monster_schedule.touched.used > 0) {
+        idPoolRelease(monster_schedule.touched, monster_schedule.touched.ids[monster_schedule.touched.used - 1]);
+    }
+}
+
+static void monsterScheduleProcessed(Monster_t const &monster, int monster_id) {
+    // Processed every turn anyway
+    if (monster_schedule.bucket_of[monster_id] == 0) {
+        return;
+    }
+
+    bool in_view = monster.lit || monster.distance_from_player <= config::monsters::MON_MAX_SIGHT;
+
+    if (in_view != idPoolInUse(monster_schedule.in_view, monster_id)) {
+        if (in_view) {
+            idPoolTake(monster_schedule.in_view, monster_id);
+        } else {
+            idPoolRelease(monster_schedule.in_view, monster_id);
+        }
+    }
+}
+
 // Creatures movement and attacking are done from here -RAK-
 void updateMonsters(bool attack) {
+    monsterScheduleStartPass(attack);
+
     // Process the monsters
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID && !game.character_is_dead; id--) {
+    for (int position = monsterScheduleNextPosition(monster_pool.used - 1); position >= 0 && !game.character_is_dead;
+         position = monsterScheduleNextPosition(position - 1)) {
+        monster_schedule.pass_position = position;
+
+        int id = monster_pool.ids[position];
         Monster_t &monster = monsters[id];
 
         // Get rid of an eaten/breathed on monster.  Note: Be sure not to
@@ -1323,6 +1536,8 @@ void updateMonsters(bool attack) {
             continue;
         }
 
+        profilerCount(COUNT_MONSTERS);
+
         monster.distance_from_player = (uint8_t) coordDistanceBetween(py.pos, Coord_t{monster.pos.y, monster.pos.x});
 
         // Attack is argument passed to CREATURE
@@ -1345,7 +1560,11 @@ void updateMonsters(bool attack) {
             dungeonDeleteMonsterRecord(id);
             continue;
         }
+
+        monsterScheduleProcessed(monster, id);
     }
+
+    monster_schedule.pass_position = -1;
 }
 
 // Decreases monsters hit points and deletes monster if needed.
@@ -1387,7 +1606,7 @@ int monsterTakeHit(int monster_id, int damage) {
 
     // in case this is called from within updateMonsters(), this is a horrible
     // hack, the monsters/updateMonsters() code needs to be rewritten.
-    if (hack_monptr < monster_id) {
+    if (hack_monptr < 0 || monsterTurnTaken(monster_id, hack_monptr)) {
         dungeonDeleteMonster(monster_id);
     } else {
         dungeonRemoveMonsterFromLevel(monster_id);
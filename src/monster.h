@@ -52,24 +52,32 @@ typedef struct {
 constexpr uint16_t MON_MAX_CREATURES = 279; // Number of creatures defined for univ
 constexpr uint8_t MON_ATTACK_TYPES = 215;   // Number of monster attack types.
 
-// With MON_TOTAL_ALLOCATIONS set to 101, it is possible to get compacting
-// monsters messages while breeding/cloning monsters.
-constexpr uint8_t MON_TOTAL_ALLOCATIONS = 125; // Max that can be allocated
+// Size of the monster list, including the unused ids 0 (no monster) and 1 (the
+// player). New monsters are not placed, and breeders do not multiply, while the
+// list is full. It may be raised as far as ID_POOL_MAX_IDS.
+constexpr uint16_t MON_TOTAL_ALLOCATIONS = 125; // Max that can be allocated
+static_assert(MON_TOTAL_ALLOCATIONS <= ID_POOL_MAX_IDS, "monster ids must fit in a tile byte");
 constexpr uint8_t MON_MAX_LEVELS = 40;         // Maximum level of creatures
 constexpr uint8_t MON_MAX_ATTACKS = 4;         // Max num attacks (used in mons memory) -CJS-
 
-extern int hack_monptr;
 extern Creature_t creatures_list[MON_MAX_CREATURES];
-extern Monster_t monsters[MON_TOTAL_ALLOCATIONS];
+extern thread_local Monster_t monsters[MON_TOTAL_ALLOCATIONS];
 extern int16_t monster_levels[MON_MAX_LEVELS + 1];
 extern MonsterAttack_t monster_attacks[MON_ATTACK_TYPES];
 extern Monster_t blank_monster;
-extern int16_t next_free_monster_id;
-extern int16_t monster_multiply_total;
+extern thread_local IdPool_t monster_pool;
+extern thread_local int16_t monster_multiply_total;
 
 void monsterUpdateVisibility(int monster_id);
 bool monsterMultiply(Coord_t coord, int creature_id, int monster_id);
 void updateMonsters(bool attack);
+void monsterScheduleReset();
+void monsterScheduleUpdate(int monster_id);
+void monsterScheduleRemove(int monster_id);
+
+// monster flow
+void monsterFlowInvalidate();
+bool monsterFlowDirections(Coord_t const &coord, int *directions);
 uint32_t monsterDeath(Coord_t coord, uint32_t flags);
 int monsterTakeHit(int monster_id, int damage);
 void printMonsterActionText(const std::string &name, const std::string &action);
@@ -77,7 +85,7 @@ std::string monsterNameDescription(const std::string &real_name, bool is_lit);
 bool monsterSleep(Coord_t coord);
 
 // monster management
-bool compactMonsters();
+bool monsterTurnTaken(int other_id, int monster_id);
 bool monsterPlaceNew(Coord_t coord, int creature_id, bool sleeping);
 void monsterPlaceWinning();
 void monsterPlaceNewWithinDistance(int number, int distance_from_source, bool sleeping);
@@ -0,0 +1,149 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Distances to the player around walls, used by chasing monsters
+
+#include "headers.h"
+
+// The number of steps from each tile to the player, found by a breadth first
+// search out from the player over the tiles a monster can walk or open a way
+// through, up to MON_FLOW_DISTANCE steps. A value of 0 means the tile was not
+// reached, otherwise the step count is one less than the value.
+// The flow is worked out on first use after the player moves, or after
+// monsterFlowInvalidate() is called, and shared by all the monsters.
+typedef struct {
+    bool valid;
+    Coord_t from;
+    int count;
+    int16_t reached[MAX_HEIGHT * MAX_WIDTH]; // y * MAX_WIDTH + x, in the order reached
+    uint8_t steps[MAX_HEIGHT][MAX_WIDTH];
+} MonsterFlow_t;
+
+static thread_local MonsterFlow_t monster_flow = {false, Coord_t{0, 0}, 0, {}, {}};
+
+// Keypad directions and the moves they make, see playerMovePosition()
+static const int flow_directions[8] = {1, 2, 3, 4, 6, 7, 8, 9};
+static const Coord_t flow_moves[10] = {
+    {0, 0}, {1, -1}, {1, 0}, {1, 1}, {0, -1}, {0, 0}, {0, 1}, {-1, -1}, {-1, 0}, {-1, 1},
+};
+
+// Floors, and the doors and rubble on blocked floors
+static bool monsterFlowPassable(int y, int x) {
+    return dg.floor.feature_ids[y][x] <= MAX_CAVE_FLOOR;
+}
+
+static void monsterFlowReach(int y, int x, uint8_t steps) {
+    monster_flow.steps[y][x] = steps;
+    monster_flow.reached[monster_flow.count] = (int16_t) (y * MAX_WIDTH + x);
+    monster_flow.count++;
+}
+
+static void monsterFlowBuild() {
+    // Only the tiles reached last time need clearing
+    for (int i = 0; i < monster_flow.count; i++) {
+        monster_flow.steps[monster_flow.reached[i] / MAX_WIDTH][monster_flow.reached[i] % MAX_WIDTH] = 0;
+    }
+    monster_flow.count = 0;
+
+    monster_flow.from = py.pos;
+    monster_flow.valid = true;
+
+    monsterFlowReach(py.pos.y, py.pos.x, 1);
+
+    for (int next = 0; next < monster_flow.count; next++) {
+        int y = monster_flow.reached[next] / MAX_WIDTH;
+        int x = monster_flow.reached[next] % MAX_WIDTH;
+        uint8_t steps = monster_flow.steps[y][x];
+
+        if (steps > config::monsters::MON_FLOW_DISTANCE) {
+            continue;
+        }
+
+        for (auto dir : flow_directions) {
+            int ny = y + flow_moves[dir].y;
+            int nx = x + flow_moves[dir].x;
+
+            if (ny < 0 || ny >= dg.height || nx < 0 || nx >= dg.width) {
+                continue;
+            }
+
+            if (monster_flow.steps[ny][nx] == 0 && monsterFlowPassable(ny, nx)) {
+                monsterFlowReach(ny, nx, (uint8_t) (steps + 1));
+            }
+        }
+    }
+}
+
+static bool monsterFlowListHas(const int *list, int count, int dir) {
+    for (int i = 0; i < count; i++) {
+        if (list[i] == dir) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Must be called whenever walls may have been added or removed.
+void monsterFlowInvalidate() {
+    monster_flow.valid = false;
+}
+
+// Reorders the five `directions` a monster at `coord` tries to move in, so the
+// steps which bring it nearer to the player come first, then those which keep
+// it as near, then the rest of the original directions. Amongst equal steps
+// the original order is kept. Returns false, leaving `directions` alone, when
+// the monster is out of reach of the flow.
+bool monsterFlowDirections(Coord_t const &coord, int *directions) {
+    if (!monster_flow.valid || monster_flow.from.y != py.pos.y || monster_flow.from.x != py.pos.x) {
+        monsterFlowBuild();
+    }
+
+    int here = monster_flow.steps[coord.y][coord.x];
+    if (here == 0) {
+        return false;
+    }
+
+    // The original directions first, then any others
+    int preferred[8];
+    int preferred_count = 0;
+
+    for (int i = 0; i < 5; i++) {
+        if (directions[i] != 5 && !monsterFlowListHas(preferred, preferred_count, directions[i])) {
+            preferred[preferred_count++] = directions[i];
+        }
+    }
+    for (auto dir : flow_directions) {
+        if (!monsterFlowListHas(preferred, preferred_count, dir)) {
+            preferred[preferred_count++] = dir;
+        }
+    }
+
+    int chosen[5];
+    int chosen_count = 0;
+
+    // Nearer first, then as near
+    for (int wanted = std::max(1, here - 1); wanted <= here && chosen_count < 5; wanted++) {
+        for (int i = 0; i < preferred_count && chosen_count < 5; i++) {
+            int dir = preferred[i];
+            int steps = monster_flow.steps[coord.y + flow_moves[dir].y][coord.x + flow_moves[dir].x];
+
+            if (steps == wanted) {
+                chosen[chosen_count++] = dir;
+            }
+        }
+    }
+
+    for (int i = 0; i < 5 && chosen_count < 5; i++) {
+        if (!monsterFlowListHas(chosen, chosen_count, directions[i])) {
+            chosen[chosen_count++] = directions[i];
+        }
+    }
+
+    for (int i = 0; i < chosen_count; i++) {
+        directions[i] = chosen[i];
+    }
+
+    return true;
+}
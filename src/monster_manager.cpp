@@ -7,24 +7,19 @@
 
 #include "headers.h"
 
-Monster_t monsters[MON_TOTAL_ALLOCATIONS];
+thread_local Monster_t monsters[MON_TOTAL_ALLOCATIONS];
 int16_t monster_levels[MON_MAX_LEVELS + 1];
 
 // Values for a blank monster
 Monster_t blank_monster = {0, 0, 0, 0, Coord_t{0, 0}, 0, false, 0, 0};
 
-int16_t next_free_monster_id;   // ID for the next available monster ptr
-int16_t monster_multiply_total; // Total number of reproduction's of creatures
+thread_local IdPool_t monster_pool;          // Ids in use in the monster list
+thread_local int16_t monster_multiply_total; // Total number of reproduction's of creatures
 
 // Returns a pointer to next free space -RAK-
 // Returns -1 if could not allocate a monster.
 static int popm() {
-    if (next_free_monster_id == MON_TOTAL_ALLOCATIONS) {
-        if (!compactMonsters()) {
-            return -1;
-        }
-    }
-    return next_free_monster_id++;
+    return idPoolAllocate(monster_pool);
 }
 
 // Places a monster at given location -RAK-
@@ -55,6 +50,8 @@ bool monsterPlaceNew(Coord_t coord, int creature_id, bool sleeping) {
     monster.lit = false;
 
     dg.floor[coord.y][coord.x].creature_id = (uint8_t) monster_id;
+    openFloorUpdate(coord);
+    monsterScheduleUpdate(monster_id);
 
     if (sleeping) {
         if (creatures_list[creature_id].sleep_counter == 0) {
@@ -77,14 +74,9 @@ void monsterPlaceWinning() {
 
     Coord_t coord = Coord_t{0, 0};
 
-    do {
-        coord.y = randomNumber(dg.height - 2);
-        coord.x = randomNumber(dg.width - 2);
-    } while (dg.floor[coord.y][coord.x].feature_id >= MIN_CLOSED_SPACE ||           //
-             dg.floor[coord.y][coord.x].creature_id != 0 ||                         //
-             dg.floor[coord.y][coord.x].treasure_id != 0 ||                         //
-             coordDistanceBetween(coord, py.pos) <= config::monsters::MON_MAX_SIGHT //
-    );
+    if (!openFloorRandomTile(coord, config::monsters::MON_MAX_SIGHT, OPEN_FLOOR_ANY_DISTANCE, nullptr)) {
+        return;
+    }
 
     int creature_id = randomNumber(config::monsters::MON_ENDGAME_MONSTERS) - 1 + monster_levels[MON_MAX_LEVELS];
 
@@ -119,6 +111,8 @@ void monsterPlaceWinning() {
     monster.distance_from_player = (uint8_t) coordDistanceBetween(py.pos, coord);
 
     dg.floor[coord.y][coord.x].creature_id = (uint8_t) monster_id;
+    openFloorUpdate(coord);
+    monsterScheduleUpdate(monster_id);
 
     monster.sleep_count = 0;
 }
@@ -164,13 +158,9 @@ void monsterPlaceNewWithinDistance(int number, int distance_from_source, bool sl
     Coord_t position = Coord_t{0, 0};
 
     for (int i = 0; i < number; i++) {
-        do {
-            position.y = randomNumber(dg.height - 2);
-            position.x = randomNumber(dg.width - 2);
-        } while (dg.floor[position.y][position.x].feature_id >= MIN_CLOSED_SPACE || //
-                 dg.floor[position.y][position.x].creature_id != 0 ||               //
-                 coordDistanceBetween(position, py.pos) <= distance_from_source     //
-        );
+        if (!openFloorRandomTile(position, distance_from_source, OPEN_FLOOR_ANY_DISTANCE, nullptr)) {
+            return;
+        }
 
         int l = monsterGetOneSuitableForLevel(dg.current_level);
 
@@ -245,41 +235,8 @@ bool monsterSummonUndead(Coord_t &coord) {
     return placeMonsterAdjacentTo(monster_id, coord, false);
 }
 
-// Compact monsters -RAK-
-// Return true if any monsters were deleted, false if could not delete any monsters.
-bool compactMonsters() {
-    printMessage("Compacting monsters...");
-
-    int cur_dis = 66;
-    bool delete_any = false;
-
-    while (!delete_any) {
-        for (int i = next_free_monster_id - 1; i >= config::monsters::MON_MIN_INDEX_ID; i--) {
-            if (cur_dis < monsters[i].distance_from_player && randomNumber(3) == 1) {
-                if ((creatures_list[monsters[i].creature_id].movement & config::monsters::move::CM_WIN) != 0u) {
-                    // Never compact away the Balrog!!
-                } else if (hack_monptr < i) {
-                    // In case this is called from within updateMonsters().
-                    // This is a horrible hack, the monsters/updateMonsters() code needs to be rewritten.
-                    dungeonDeleteMonster(i);
-                    delete_any = true;
-                } else {
-                    // dungeonRemoveMonsterFromLevel() does not decrement next_free_monster_id,
-                    // so don't set delete_any if this was called.
-                    dungeonRemoveMonsterFromLevel(i);
-                }
-            }
-        }
-
-        if (!delete_any) {
-            cur_dis -= 6;
-
-            // Can't delete any monsters, return failure.
-            if (cur_dis < 0) {
-                return false;
-            }
-        }
-    }
-
-    return true;
+// updateMonsters() works back from the last monster in the pool to the first,
+// so while `monster_id` takes its turn, has `other_id` had its turn already?
+bool monsterTurnTaken(int other_id, int monster_id) {
+    return monster_pool.positions[monster_id] < monster_pool.positions[other_id];
 }
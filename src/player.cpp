@@ -8,7 +8,7 @@
 #include "headers.h"
 
 // Player record for most player related info
-Player_t py = Player_t{};
+thread_local Player_t py = Player_t{};
 
 static void playerResetFlags() {
     py.flags.see_invisible = false;
@@ -102,10 +102,42 @@ bool playerMovePosition(int dir, Coord_t &coord) {
     return can_move;
 }
 
+// Random landings tried by playerTeleport() before it counts the tiles one by one.
+constexpr int PLAYER_TELEPORT_TRIES = 100;
+
+// The player can land on any open space, objects included, with no monster on it.
+static bool playerCanLandOn(Coord_t const &coord) {
+    return dg.floor[coord.y][coord.x].feature_id < MIN_CLOSED_SPACE && dg.floor[coord.y][coord.x].creature_id < 2;
+}
+
+// Picks the landing numbered `pick` (from 1) within `new_distance` of the
+// player, or counts them when `pick` is 0. The player's own tile is one.
+static int playerTeleportScan(int pick, int new_distance, Coord_t &location) {
+    int found = 0;
+
+    Coord_t spot = Coord_t{0, 0};
+    for (spot.y = std::max(0, py.pos.y - new_distance); spot.y <= std::min(dg.height - 1, py.pos.y + new_distance); spot.y++) {
+        for (spot.x = std::max(0, py.pos.x - new_distance); spot.x <= std::min(dg.width - 1, py.pos.x + new_distance); spot.x++) {
+            if (!playerCanLandOn(spot) || coordDistanceBetween(spot, py.pos) > new_distance) {
+                continue;
+            }
+
+            found++;
+            if (found == pick) {
+                location = spot;
+                return found;
+            }
+        }
+    }
+
+    return found;
+}
+
 // Teleport the player to a new location -RAK-
 void playerTeleport(int new_distance) {
     Coord_t location = Coord_t{0, 0};
 
+    int tries = 0;
     do {
         location.y = randomNumber(dg.height) - 1;
         location.x = randomNumber(dg.width) - 1;
@@ -114,7 +146,16 @@ void playerTeleport(int new_distance) {
             location.y += (py.pos.y - location.y) / 2;
             location.x += (py.pos.x - location.x) / 2;
         }
-    } while (dg.floor[location.y][location.x].feature_id >= MIN_CLOSED_SPACE || dg.floor[location.y][location.x].creature_id >= 2);
+
+        tries++;
+    } while (!playerCanLandOn(location) && tries < PLAYER_TELEPORT_TRIES);
+
+    // A crowded level, pick one of the landings left. There is always
+    // at least one, as the player can stay put.
+    if (!playerCanLandOn(location)) {
+        int found = playerTeleportScan(0, new_distance, location);
+        (void) playerTeleportScan(randomNumber(found), new_distance, location);
+    }
 
     dungeonMoveCreatureRecord(py.pos, location);
 
@@ -176,6 +217,12 @@ void playerSearchOn() {
     py.flags.food_digested++;
 }
 
+// Resting, running or repeating a command, all of which
+// carry on without input until the player is disturbed.
+bool playerIsBusy() {
+    return py.flags.rest != 0 || py.running_tracker != 0 || game.command_count > 0;
+}
+
 void playerSearchOff() {
     dungeonResetView();
     playerChangeSpeed(-1);
@@ -371,8 +418,10 @@ void playerChangeSpeed(int speed) {
     py.flags.speed += speed;
     py.flags.status |= config::player::status::PY_SPEED;
 
-    for (int i = next_free_monster_id - 1; i >= config::monsters::MON_MIN_INDEX_ID; i--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int i = monster_pool.ids[position];
         monsters[i].speed += speed;
+        monsterScheduleUpdate(i);
     }
 }
 
@@ -1237,7 +1286,7 @@ static int16_t playerLockPickingSkill() {
 }
 
 static void openClosedDoor(Coord_t coord) {
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
     Inventory_t &item = game.treasure.list[tile.treasure_id];
 
     if (item.misc_use > 0) {
@@ -1262,6 +1311,7 @@ static void openClosedDoor(Coord_t coord) {
     if (item.misc_use == 0) {
         inventoryItemCopyTo(config::dungeon::objects::OBJ_OPEN_DOOR, game.treasure.list[tile.treasure_id]);
         tile.feature_id = TILE_CORR_FLOOR;
+        losMapChanged();
         dungeonLiteSpot(coord);
         game.command_count = 0;
     }
@@ -1363,7 +1413,7 @@ void playerCloseDoor() {
     Coord_t coord = py.pos;
     (void) playerMovePosition(dir, coord);
 
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
     Inventory_t &item = game.treasure.list[tile.treasure_id];
 
     bool no_object = false;
@@ -1374,6 +1424,7 @@ void playerCloseDoor() {
                 if (item.misc_use == 0) {
                     inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, item);
                     tile.feature_id = TILE_BLOCKED_FLOOR;
+                    losMapChanged();
                     dungeonLiteSpot(coord);
                 } else {
                     printMessage("The door appears to be broken.");
@@ -1401,7 +1452,7 @@ bool playerTunnelWall(Coord_t coord, int digging_ability, int digging_chance) {
         return false;
     }
 
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
 
     if (tile.perma_lit_room) {
         // Should become a room space, check to see whether
@@ -1428,6 +1479,8 @@ bool playerTunnelWall(Coord_t coord, int digging_ability, int digging_chance) {
         tile.feature_id = TILE_CORR_FLOOR;
         tile.permanent_light = false;
     }
+    losMapChanged();
+    openFloorUpdate(coord);
 
     tile.field_mark = false;
 
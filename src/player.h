@@ -176,7 +176,7 @@ typedef struct Player_t {
     bool carrying_light = false;  // `true` when player is carrying light
 } Player_t;
 
-extern Player_t py;
+extern thread_local Player_t py;
 
 extern ClassRankTitle_t class_rank_titles[PLAYER_MAX_CLASSES][PLAYER_MAX_LEVEL];
 extern Race_t character_races[PLAYER_MAX_RACES];
@@ -199,6 +199,7 @@ void playerSearchOn();
 void playerSearchOff();
 void playerRestOn();
 void playerRestOff();
+bool playerIsBusy();
 void playerDiedFromString(vtype_t *description, const char *monster_name, uint32_t move);
 bool playerTestAttackHits(int attack_id, uint8_t level);
 
@@ -17,7 +17,7 @@ typedef struct {
     uint8_t attacks[MON_MAX_ATTACKS];
 } Recall_t;
 
-extern Recall_t creature_recall[MON_MAX_CREATURES]; // Monster memories. -CJS-
+extern thread_local Recall_t creature_recall[MON_MAX_CREATURES]; // Monster memories. -CJS-
 extern const char *recall_description_attack_type[25];
 extern const char *recall_description_attack_method[20];
 extern const char *recall_description_how_much[8];
@@ -27,21 +27,14 @@
 // The u's form a pseudo-random sequence of real numbers between (but not
 // including) 0 and 1.
 //
-// Schrage's method is used to compute the sequence of z's.
-// Let m = aq + r, where q = m div a, and r = m mod a.
-// Then f(z) = az mod m = az - m * (az div m) =
-//           = gamma(z) + m * delta(z)
-// Where gamma(z) = a(z mod q) - r(z div q)
-// and   delta(z) = (z div q) - (az div m)
+// As m = 2^31 - 1, az mod m is found without dividing. Writing az as
+// h * 2^31 + l, where l < 2^31, gives az = h * (m + 1) + l, and so
+// az mod m = (h + l) mod m. For z and a below m, h + l is below 2m, so a
+// single subtraction of m is left to do. Any multiplier below m works the
+// same way, as the product of two numbers below 2^31 fits in 64 bits.
 //
-// If r < q, then for all z in 1, 2, ..., m - 1:
-//   (1) delta(z) is either 0 or 1
-//   (2) both a(z mod q) and r(z div q) are in 0, 1, ..., m - 1
-//   (3) absolute value of gamma(z) <= m - 1
-//   (4) delta(z) = 1 iff gamma(z) < 0
-//
-// Hence each value of z can be computed exactly without overflow as long
-// as m can be represented as an integer.
+// The numbers a stream is moved on by are found from z[n+k] = (a^k mod m) z[n]
+// mod m, which rngJump() and rngFill() use.
 
 // a good random number generator, correct on any machine with 32 bit
 // integers, this algorithm is from:
@@ -57,40 +50,125 @@
 //  Has a full period of 2^31 - 1.
 //  Returns integers in the range 1 to 2^31-1.
 
-constexpr int32_t RNG_M = INT_MAX; // m = 2^31 - 1
-constexpr int32_t RNG_A = 16807L;
-constexpr int32_t RNG_Q = RNG_M / RNG_A; // m div a 127773L
-constexpr int32_t RNG_R = RNG_M % RNG_A; // m mod a 2836L
+constexpr uint32_t RNG_M = INT_MAX; // m = 2^31 - 1
+constexpr uint64_t RNG_A = 16807L;
+constexpr uint64_t RNG_A2 = RNG_A * RNG_A % RNG_M; // a^2 mod m
+constexpr uint64_t RNG_A3 = RNG_A2 * RNG_A % RNG_M;
+constexpr uint64_t RNG_A4 = RNG_A3 * RNG_A % RNG_M;
 
-// 32 bit seed
-static uint32_t rnd_seed;
+// Returns z * multiplier mod m, for z and multiplier in 1, 2, ..., m - 1
+static uint32_t rngMultiply(uint64_t z, uint64_t multiplier) {
+    uint64_t product = z * multiplier;
+    auto result = (uint32_t) ((product & RNG_M) + (product >> 31));
 
-uint32_t getRandomSeed() {
-    return rnd_seed;
+    if (result >= RNG_M) {
+        result -= RNG_M;
+    }
+    return result;
 }
 
-void setRandomSeed(uint32_t seed) {
+// The game stream, used unless another stream is selected with rngSelect().
+static thread_local Rng_t rng_game = {0};
+static thread_local Rng_t *rng_selected = nullptr;
+
+// The stream used by rnd() and randomNumber()
+Rng_t &rngCurrent() {
+    return rng_selected != nullptr ? *rng_selected : rng_game;
+}
+
+// Returns a stream starting from `seed`, as setRandomSeed() would.
+Rng_t rngCreate(uint32_t seed) {
     // set seed to value between 1 and m-1
-    rnd_seed = (uint32_t) ((seed % (RNG_M - 1)) + 1);
+    return Rng_t{(seed % (RNG_M - 1)) + 1};
+}
+
+// Makes `rng` the stream used by rnd() and randomNumber() (the game stream
+// when nullptr). Returns the stream used until now, to select it again later.
+Rng_t *rngSelect(Rng_t *rng) {
+    Rng_t *previous = rng_selected;
+    rng_selected = rng;
+    return previous;
 }
 
 // returns a pseudo-random number from set 1, 2, ..., RNG_M - 1
-int32_t rnd() {
-    auto high = (int32_t) (rnd_seed / RNG_Q);
-    auto low = (int32_t) (rnd_seed % RNG_Q);
-    auto test = (int32_t) (RNG_A * low - RNG_R * high);
-
-    if (test > 0) {
-        rnd_seed = (uint32_t) test;
-    } else {
-        rnd_seed = (uint32_t) (test + RNG_M);
+int32_t rngNext(Rng_t &rng) {
+    rng.seed = rngMultiply(rng.seed, RNG_A);
+    return (int32_t) rng.seed;
+}
+
+// Fills `values` with the next `count` numbers of `rng`, the same numbers
+// `count` calls to rngNext() give. Four numbers at a time are worked out
+// from the one before them, so they do not wait on each other.
+void rngFill(Rng_t &rng, int32_t *values, int count) {
+    uint32_t z = rng.seed;
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        values[i] = (int32_t) rngMultiply(z, RNG_A);
+        values[i + 1] = (int32_t) rngMultiply(z, RNG_A2);
+        values[i + 2] = (int32_t) rngMultiply(z, RNG_A3);
+        z = rngMultiply(z, RNG_A4);
+        values[i + 3] = (int32_t) z;
+    }
+
+    for (; i < count; i++) {
+        z = rngMultiply(z, RNG_A);
+        values[i] = (int32_t) z;
+    }
+
+    rng.seed = z;
+}
+
+// Moves `rng` on by `steps` numbers without generating them: as z[n+1] = az mod m,
+// z[n+k] = (a^k mod m) z[n] mod m, with a^k found by repeated squaring.
+void rngJump(Rng_t &rng, uint64_t steps) {
+    // The sequence repeats every m - 1 numbers
+    steps %= RNG_M - 1;
+
+    uint64_t multiplier = 1;
+    uint64_t power = RNG_A;
+
+    for (; steps != 0; steps >>= 1) {
+        if ((steps & 1) != 0) {
+            multiplier = rngMultiply(multiplier, power);
+        }
+        power = rngMultiply(power, power);
     }
-    return rnd_seed;
+
+    rng.seed = rngMultiply(rng.seed, multiplier);
+}
+
+// Returns stream number `stream` split off from `rng`: the numbers of `rng`
+// from RNG_STREAM_LENGTH * `stream` on, so streams split off the same `rng`
+// never overlap within RNG_STREAM_LENGTH numbers, and are always the same.
+Rng_t rngSplit(Rng_t const &rng, uint32_t stream) {
+    Rng_t split = rng;
+    rngJump(split, RNG_STREAM_LENGTH * stream);
+    return split;
+}
+
+uint32_t getRandomSeed() {
+    return rngCurrent().seed;
+}
+
+void setRandomSeed(uint32_t seed) {
+    rngCurrent() = rngCreate(seed);
+}
+
+// Seeds the current stream with its own state, which adds one to it (mod m - 1).
+// The town and the item names used to swap the game seed out and back in with
+// setRandomSeed(), so they still do this to keep seeded games the same.
+void rngReseed() {
+    setRandomSeed(getRandomSeed());
+}
+
+int32_t rnd() {
+    return rngNext(rngCurrent());
 }
 
 #ifdef TEST_RNG
 
-main() {
+int main() {
     setRandomSeed(0L);
 
     for (int32_t i = 1; i < 10000; i++) {
@@ -99,9 +177,16 @@ main() {
 
     int32_t random = rnd();
 
-    printf("z[10001] = %ld, should be 1043618065\n", random);
+    printf("z[10001] = %d, should be 1043618065\n", random);
+
+    // The same again, in one go
+    Rng_t rng = rngCreate(0L);
+    int32_t values[10000];
+    rngFill(rng, values, 10000);
+
+    printf("filled z[10001] = %d\n", values[9999]);
 
-    if (random == 1043618065L) {
+    if (random == 1043618065L && values[9999] == random) {
         printf("success!!!\n");
     }
 }
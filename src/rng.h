@@ -5,7 +5,26 @@
 
 #pragma once
 
+// Rng_t is one stream of the Park-Miller random number generator. Each
+// game thread has its own game stream, used by rnd() and randomNumber()
+// unless another stream is selected, and other streams can be made from a
+// seed or split off a stream, and passed to randomNumber() and friends.
+typedef struct {
+    uint32_t seed;
+} Rng_t;
+
+// Numbers of a stream before the next stream split off it, see rngSplit().
+constexpr uint64_t RNG_STREAM_LENGTH = 1ULL << 24;
+
 // rng.cpp
+Rng_t rngCreate(uint32_t seed);
+Rng_t *rngSelect(Rng_t *rng);
+Rng_t &rngCurrent();
+int32_t rngNext(Rng_t &rng);
+void rngFill(Rng_t &rng, int32_t *values, int count);
+void rngJump(Rng_t &rng, uint64_t steps);
+Rng_t rngSplit(Rng_t const &rng, uint32_t stream);
 uint32_t getRandomSeed();
 void setRandomSeed(uint32_t seed);
+void rngReseed();
 int32_t rnd();
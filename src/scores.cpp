@@ -9,7 +9,10 @@
 #include "version.h"
 
 // High score file pointer
-FILE *highscore_fp;
+thread_local FILE *highscore_fp;
+
+// Games hosted on other threads share the one score file.
+static std::mutex highscore_mutex;
 
 static uint8_t highScoreGenderLabel() {
     if (playerIsMale()) {
@@ -56,6 +59,8 @@ void recordNewHighScore() {
     }
     (void) strcpy(new_entry.died_from, tmp);
 
+    std::lock_guard<std::mutex> lock(highscore_mutex);
+
     if ((highscore_fp = fopen(config::files::scores.c_str(), "rb+")) == nullptr) {
         printMessage(("Error opening score file '" + config::files::scores + "'.").c_str());
         printMessage(CNIL);
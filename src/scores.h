@@ -28,7 +28,7 @@ typedef struct {
 // Number of entries allowed in the score file.
 constexpr uint16_t MAX_HIGH_SCORE_ENTRIES = 1000;
 
-extern FILE *highscore_fp;
+extern thread_local FILE *highscore_fp;
 
 // TODO: these are implemented in `game_save.cpp` so need moving.
 void saveHighScore(HighScore_t const &score);
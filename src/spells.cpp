@@ -162,7 +162,7 @@ bool spellDetectTreasureWithinVicinity() {
 
     for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
         for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+            Tile_t tile = dg.floor[coord.y][coord.x];
 
             if (tile.treasure_id != 0 && game.treasure.list[tile.treasure_id].category_id == TV_GOLD && !caveTileVisible(coord)) {
                 tile.field_mark = true;
@@ -183,7 +183,7 @@ bool spellDetectObjectsWithinVicinity() {
 
     for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
         for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+            Tile_t tile = dg.floor[coord.y][coord.x];
 
             if (tile.treasure_id != 0 && game.treasure.list[tile.treasure_id].category_id < TV_MAX_OBJECT && !caveTileVisible(coord)) {
                 tile.field_mark = true;
@@ -204,7 +204,7 @@ bool spellDetectTrapsWithinVicinity() {
 
     for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
         for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+            Tile_t tile = dg.floor[coord.y][coord.x];
 
             if (tile.treasure_id == 0) {
                 continue;
@@ -232,7 +232,7 @@ bool spellDetectSecretDoorssWithinVicinity() {
 
     for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
         for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+            Tile_t tile = dg.floor[coord.y][coord.x];
 
             if (tile.treasure_id == 0) {
                 continue;
@@ -261,7 +261,8 @@ bool spellDetectSecretDoorssWithinVicinity() {
 bool spellDetectInvisibleCreaturesWithinVicinity() {
     bool detected = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t &monster = monsters[id];
 
         if (coordInsidePanel(Coord_t{monster.pos.y, monster.pos.x}) && ((creatures_list[monster.creature_id].movement & config::monsters::move::CM_INVISIBLE) != 0u)) {
@@ -329,11 +330,13 @@ bool spellDarkenArea(Coord_t coord) {
 
         for (spot.y = start_row; spot.y <= end_row; spot.y++) {
             for (spot.x = start_col; spot.x <= end_col; spot.x++) {
-                Tile_t &tile = dg.floor[spot.y][spot.x];
+                Tile_t tile = dg.floor[spot.y][spot.x];
 
                 if (tile.perma_lit_room && tile.feature_id <= MAX_CAVE_FLOOR) {
                     tile.permanent_light = false;
                     tile.feature_id = TILE_DARK_FLOOR;
+                    losMapChanged();
+                    openFloorUpdate(spot);
 
                     dungeonLiteSpot(spot);
 
@@ -346,7 +349,7 @@ bool spellDarkenArea(Coord_t coord) {
     } else {
         for (spot.y = coord.y - 1; spot.y <= coord.y + 1; spot.y++) {
             for (spot.x = coord.x - 1; spot.x <= coord.x + 1; spot.x++) {
-                Tile_t &tile = dg.floor[spot.y][spot.x];
+                Tile_t tile = dg.floor[spot.y][spot.x];
 
                 if (tile.feature_id == TILE_CORR_FLOOR && tile.permanent_light) {
                     // permanent_light could have been set by star-lite wand, etc
@@ -369,7 +372,7 @@ static void dungeonLightAreaAroundFloorTile(Coord_t coord) {
 
     for (spot.y = coord.y - 1; spot.y <= coord.y + 1; spot.y++) {
         for (spot.x = coord.x - 1; spot.x <= coord.x + 1; spot.x++) {
-            Tile_t &tile = dg.floor[spot.y][spot.x];
+            Tile_t tile = dg.floor[spot.y][spot.x];
 
             if (tile.feature_id >= MIN_CAVE_WALL) {
                 tile.permanent_light = true;
@@ -432,12 +435,14 @@ bool spellIdentifyItem() {
 bool spellAggravateMonsters(int affect_distance) {
     bool aggravated = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t &monster = monsters[id];
         monster.sleep_count = 0;
 
         if (monster.distance_from_player <= affect_distance && monster.speed < 2) {
             monster.speed++;
+            monsterScheduleUpdate(id);
             aggravated = true;
         }
     }
@@ -498,7 +503,7 @@ bool spellSurroundPlayerWithDoors() {
                 continue;
             }
 
-            Tile_t &tile = dg.floor[coord.y][coord.x];
+            Tile_t tile = dg.floor[coord.y][coord.x];
 
             if (tile.feature_id <= MAX_CAVE_FLOOR) {
                 if (tile.treasure_id != 0) {
@@ -507,7 +512,8 @@ bool spellSurroundPlayerWithDoors() {
 
                 int free_id = popt();
                 tile.feature_id = TILE_BLOCKED_FLOOR;
-                tile.treasure_id = (uint8_t) free_id;
+                dungeonSetTreasureId(coord, free_id);
+                losMapChanged();
 
                 inventoryItemCopyTo(config::dungeon::objects::OBJ_CLOSED_DOOR, game.treasure.list[free_id]);
                 dungeonLiteSpot(coord);
@@ -560,7 +566,8 @@ bool spellDestroyAdjacentDoorsTraps() {
 bool spellDetectMonsters() {
     bool detected = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t &monster = monsters[id];
 
         if (coordInsidePanel(Coord_t{monster.pos.y, monster.pos.x}) && (creatures_list[monster.creature_id].movement & config::monsters::move::CM_INVISIBLE) == 0) {
@@ -615,9 +622,9 @@ void spellLightLine(Coord_t coord, int direction) {
     Coord_t tmp_coord = Coord_t{0, 0};
 
     while (!finished) {
-        Tile_t &tile = dg.floor[coord.y][coord.x];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             (void) playerMovePosition(direction, coord);
             finished = true;
             continue; // we're done here, break out of the loop
@@ -671,15 +678,16 @@ bool spellDisarmAllInDirection(Coord_t coord, int direction) {
     int distance = 0;
     bool disarmed = false;
 
-    Tile_t *tile = nullptr;
+    Coord_t spot = Coord_t{0, 0};
 
     do {
-        tile = &dg.floor[coord.y][coord.x];
+        spot = coord;
+        Tile_t tile = dg.floor[spot.y][spot.x];
 
         // note, must continue up to and including the first non open space,
         // because secret doors have feature_id greater than MAX_OPEN_SPACE
-        if (tile->treasure_id != 0) {
-            Inventory_t &item = game.treasure.list[tile->treasure_id];
+        if (tile.treasure_id != 0) {
+            Inventory_t &item = game.treasure.list[tile.treasure_id];
 
             if (item.category_id == TV_INVIS_TRAP || item.category_id == TV_VIS_TRAP) {
                 if (dungeonDeleteObject(coord)) {
@@ -689,7 +697,7 @@ bool spellDisarmAllInDirection(Coord_t coord, int direction) {
                 // Locked or jammed doors become merely closed.
                 item.misc_use = 0;
             } else if (item.category_id == TV_SECRET_DOOR) {
-                tile->field_mark = true;
+                tile.field_mark = true;
                 trapChangeVisibility(coord);
                 disarmed = true;
             } else if (item.category_id == TV_CHEST && item.flags != 0) {
@@ -707,7 +715,7 @@ bool spellDisarmAllInDirection(Coord_t coord, int direction) {
         (void) playerMovePosition(direction, coord);
 
         distance++;
-    } while (distance <= config::treasure::OBJECT_BOLTS_MAX_RANGE && tile->feature_id <= MAX_OPEN_SPACE);
+    } while (distance <= config::treasure::OBJECT_BOLTS_MAX_RANGE && dg.floor[spot.y][spot.x].feature_id <= MAX_OPEN_SPACE);
 
     return disarmed;
 }
@@ -767,7 +775,7 @@ static void printBoltStrikesMonsterMessage(Creature_t const &creature, const std
 }
 
 // Light up, draw, and check for monster damage when Fire Bolt touches it.
-static void spellFireBoltTouchesMonster(Tile_t &tile, int damage, int harm_type, uint32_t weapon_id, const std::string &bolt_name) {
+static void spellFireBoltTouchesMonster(Tile_t tile, int damage, int harm_type, uint32_t weapon_id, const std::string &bolt_name) {
     Monster_t const &monster = monsters[tile.creature_id];
     Creature_t const &creature = creatures_list[monster.creature_id];
 
@@ -824,11 +832,11 @@ void spellFireBolt(Coord_t coord, int direction, int damage_hp, int spell_type,
 
         distance++;
 
-        Tile_t &tile = dg.floor[coord.y][coord.x];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
         dungeonLiteSpot(old_coord);
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue; // we're done here, break out of the loop
         }
@@ -876,12 +884,10 @@ void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type,
             continue;
         }
 
-        Tile_t *tile = &dg.floor[coord.y][coord.x];
-
-        if (tile->feature_id >= MIN_CLOSED_SPACE || tile->creature_id > 1) {
+        if (losTileIsOpaque(coord) || dg.floor[coord.y][coord.x].creature_id > 1) {
             finished = true;
 
-            if (tile->feature_id >= MIN_CLOSED_SPACE) {
+            if (losTileIsOpaque(coord)) {
                 coord.y = old_coord.y;
                 coord.x = old_coord.x;
             }
@@ -895,21 +901,21 @@ void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type,
                     spot.x = col;
 
                     if (coordInBounds(spot) && coordDistanceBetween(coord, spot) <= max_distance && los(coord, spot)) {
-                        tile = &dg.floor[spot.y][spot.x];
+                        Tile_t tile = dg.floor[spot.y][spot.x];
 
-                        if (tile->treasure_id != 0 && (*destroy)(&game.treasure.list[tile->treasure_id])) {
+                        if (tile.treasure_id != 0 && (*destroy)(&game.treasure.list[tile.treasure_id])) {
                             (void) dungeonDeleteObject(spot);
                         }
 
-                        if (tile->feature_id <= MAX_OPEN_SPACE) {
-                            if (tile->creature_id > 1) {
-                                Monster_t const &monster = monsters[tile->creature_id];
+                        if (!losTileIsOpaque(spot)) {
+                            if (tile.creature_id > 1) {
+                                Monster_t const &monster = monsters[tile.creature_id];
                                 Creature_t const &creature = creatures_list[monster.creature_id];
 
                                 // lite up creature if visible, temp set permanent_light so that monsterUpdateVisibility works
-                                bool saved_lit_status = tile->permanent_light;
-                                tile->permanent_light = true;
-                                monsterUpdateVisibility((int) tile->creature_id);
+                                bool saved_lit_status = tile.permanent_light;
+                                tile.permanent_light = true;
+                                monsterUpdateVisibility((int) tile.creature_id);
 
                                 total_hits++;
                                 int damage = damage_hp;
@@ -928,10 +934,10 @@ void spellFireBall(Coord_t coord, int direction, int damage_hp, int spell_type,
 
                                 damage = (damage / (coordDistanceBetween(spot, coord) + 1));
 
-                                if (monsterTakeHit((int) tile->creature_id, damage) >= 0) {
+                                if (monsterTakeHit((int) tile.creature_id, damage) >= 0) {
                                     total_kills++;
                                 }
-                                tile->permanent_light = saved_lit_status;
+                                tile.permanent_light = saved_lit_status;
                             } else if (coordInsidePanel(spot) && py.flags.blind < 1) {
                                 panelPutTile('*', spot);
                             }
@@ -1001,7 +1007,7 @@ void spellBreath(Coord_t coord, int monster_id, int damage_hp, int spell_type, c
                     (void) dungeonDeleteObject(location);
                 }
 
-                if (tile.feature_id <= MAX_OPEN_SPACE) {
+                if (!losTileIsOpaque(location)) {
                     // must test status bit, not py.flags.blind here, flag could have
                     // been set by a previous monster, but the breath should still
                     // be visible until the blindness takes effect
@@ -1042,7 +1048,7 @@ void spellBreath(Coord_t coord, int monster_id, int damage_hp, int spell_type, c
                             }
 
                             // It ate an already processed monster. Handle normally.
-                            if (monster_id < tile.creature_id) {
+                            if (monsterTurnTaken((int) tile.creature_id, monster_id)) {
                                 dungeonDeleteMonster((int) tile.creature_id);
                             } else {
                                 // If it eats this monster, an already processed monster
@@ -1157,7 +1163,7 @@ bool spellChangeMonsterHitPoints(Coord_t coord, int direction, int damage_hp) {
 
         Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue;
         }
@@ -1196,7 +1202,7 @@ bool spellDrainLifeFromMonster(Coord_t coord, int direction) {
 
         Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue;
         }
@@ -1240,7 +1246,7 @@ bool spellSpeedMonster(Coord_t coord, int direction, int speed) {
 
         Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue;
         }
@@ -1255,6 +1261,7 @@ bool spellSpeedMonster(Coord_t coord, int direction, int speed) {
 
             if (speed > 0) {
                 monster.speed += speed;
+                monsterScheduleUpdate(tile.creature_id);
                 monster.sleep_count = 0;
 
                 changed = true;
@@ -1262,6 +1269,7 @@ bool spellSpeedMonster(Coord_t coord, int direction, int speed) {
                 printMonsterActionText(name, "starts moving faster.");
             } else if (randomNumber(MON_MAX_LEVELS) > creature.level) {
                 monster.speed += speed;
+                monsterScheduleUpdate(tile.creature_id);
                 monster.sleep_count = 0;
 
                 changed = true;
@@ -1290,7 +1298,7 @@ bool spellConfuseMonster(Coord_t coord, int direction) {
 
         Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue;
         }
@@ -1345,7 +1353,7 @@ bool spellSleepMonster(Coord_t coord, int direction) {
 
         Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue;
         }
@@ -1461,17 +1469,15 @@ bool spellDestroyDoorsTrapsInDirection(Coord_t coord, int direction) {
     bool destroyed = false;
     int distance = 0;
 
-    Tile_t *tile = nullptr;
-
     do {
         (void) playerMovePosition(direction, coord);
         distance++;
 
-        tile = &dg.floor[coord.y][coord.x];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
         // must move into first closed spot, as it might be a secret door
-        if (tile->treasure_id != 0) {
-            Inventory_t &item = game.treasure.list[tile->treasure_id];
+        if (tile.treasure_id != 0) {
+            Inventory_t &item = game.treasure.list[tile.treasure_id];
 
             if (item.category_id == TV_INVIS_TRAP || item.category_id == TV_CLOSED_DOOR || item.category_id == TV_VIS_TRAP || item.category_id == TV_OPEN_DOOR ||
                 item.category_id == TV_SECRET_DOOR) {
@@ -1489,7 +1495,7 @@ bool spellDestroyDoorsTrapsInDirection(Coord_t coord, int direction) {
                 spellItemIdentifyAndRemoveRandomInscription(item);
             }
         }
-    } while ((distance <= config::treasure::OBJECT_BOLTS_MAX_RANGE) || tile->feature_id <= MAX_OPEN_SPACE);
+    } while ((distance <= config::treasure::OBJECT_BOLTS_MAX_RANGE) || dg.floor[coord.y][coord.x].feature_id <= MAX_OPEN_SPACE);
 
     return destroyed;
 }
@@ -1507,7 +1513,7 @@ bool spellPolymorphMonster(Coord_t coord, int direction) {
 
         Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue;
         }
@@ -1548,9 +1554,9 @@ bool spellBuildWall(Coord_t coord, int direction) {
         (void) playerMovePosition(direction, coord);
         distance++;
 
-        Tile_t &tile = dg.floor[coord.y][coord.x];
+        Tile_t tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue; // we're done here, break out of the loop
         }
@@ -1592,6 +1598,8 @@ bool spellBuildWall(Coord_t coord, int direction) {
 
         tile.feature_id = TILE_MAGMA_WALL;
         tile.field_mark = false;
+        losMapChanged();
+        openFloorUpdate(coord);
 
         // Permanently light this wall if it is lit by player's lamp.
         tile.permanent_light = (tile.temporary_light || tile.permanent_light);
@@ -1614,7 +1622,7 @@ bool spellCloneMonster(Coord_t coord, int direction) {
 
         Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
         } else if (tile.creature_id > 1) {
             monsters[tile.creature_id].sleep_count = 0;
@@ -1711,7 +1719,7 @@ bool spellTeleportAwayMonsterInDirection(Coord_t coord, int direction) {
 
         Tile_t const &tile = dg.floor[coord.y][coord.x];
 
-        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || tile.feature_id >= MIN_CLOSED_SPACE) {
+        if (distance > config::treasure::OBJECT_BOLTS_MAX_RANGE || losTileIsOpaque(coord)) {
             finished = true;
             continue;
         }
@@ -1734,7 +1742,8 @@ bool spellTeleportAwayMonsterInDirection(Coord_t coord, int direction) {
 bool spellMassGenocide() {
     bool killed = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t const &monster = monsters[id];
         Creature_t const &creature = creatures_list[monster.creature_id];
 
@@ -1758,7 +1767,8 @@ bool spellGenocide() {
 
     bool killed = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t const &monster = monsters[id];
         Creature_t const &creature = creatures_list[monster.creature_id];
 
@@ -1783,18 +1793,20 @@ bool spellGenocide() {
 bool spellSpeedAllMonsters(int speed) {
     bool speedy = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t &monster = monsters[id];
         Creature_t const &creature = creatures_list[monster.creature_id];
 
         auto name = monsterNameDescription(creature.name, monster.lit);
 
-        if (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !los(py.pos, monster.pos)) {
+        if (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !losFromPlayer(monster.pos)) {
             continue; // do nothing
         }
 
         if (speed > 0) {
             monster.speed += speed;
+            monsterScheduleUpdate(id);
             monster.sleep_count = 0;
 
             if (monster.lit) {
@@ -1803,6 +1815,7 @@ bool spellSpeedAllMonsters(int speed) {
             }
         } else if (randomNumber(MON_MAX_LEVELS) > creature.level) {
             monster.speed += speed;
+            monsterScheduleUpdate(id);
             monster.sleep_count = 0;
 
             if (monster.lit) {
@@ -1822,13 +1835,14 @@ bool spellSpeedAllMonsters(int speed) {
 bool spellSleepAllMonsters() {
     bool asleep = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t &monster = monsters[id];
         Creature_t const &creature = creatures_list[monster.creature_id];
 
         auto name = monsterNameDescription(creature.name, monster.lit);
 
-        if (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !los(py.pos, monster.pos)) {
+        if (monster.distance_from_player > config::monsters::MON_MAX_SIGHT || !losFromPlayer(monster.pos)) {
             continue; // do nothing
         }
 
@@ -1857,7 +1871,8 @@ bool spellMassPolymorph() {
     bool morphed = false;
     Coord_t coord = Coord_t{0, 0};
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t const &monster = monsters[id];
 
         if (monster.distance_from_player <= config::monsters::MON_MAX_SIGHT) {
@@ -1881,7 +1896,8 @@ bool spellMassPolymorph() {
 bool spellDetectEvil() {
     bool detected = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t &monster = monsters[id];
 
         if (coordInsidePanel(Coord_t{monster.pos.y, monster.pos.x}) && ((creatures_list[monster.creature_id].defenses & config::monsters::defense::CD_EVIL) != 0)) {
@@ -1974,7 +1990,7 @@ void spellEarthquake() {
     for (coord.y = py.pos.y - 8; coord.y <= py.pos.y + 8; coord.y++) {
         for (coord.x = py.pos.x - 8; coord.x <= py.pos.x + 8; coord.x++) {
             if ((coord.y != py.pos.y || coord.x != py.pos.x) && coordInBounds(coord) && randomNumber(8) == 1) {
-                Tile_t &tile = dg.floor[coord.y][coord.x];
+                Tile_t tile = dg.floor[coord.y][coord.x];
 
                 if (tile.treasure_id != 0) {
                     (void) dungeonDeleteObject(coord);
@@ -2001,6 +2017,8 @@ void spellEarthquake() {
 
                     tile.field_mark = false;
                 }
+                losMapChanged();
+                openFloorUpdate(coord);
                 dungeonLiteSpot(coord);
             }
         }
@@ -2032,11 +2050,12 @@ void spellCreateFood() {
 bool spellDispelCreature(int creature_defense, int damage) {
     bool dispelled = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t const &monster = monsters[id];
 
         if (monster.distance_from_player <= config::monsters::MON_MAX_SIGHT && ((creature_defense & creatures_list[monster.creature_id].defenses) != 0) &&
-            los(py.pos, monster.pos)) {
+            losFromPlayer(monster.pos)) {
             Creature_t const &creature = creatures_list[monster.creature_id];
 
             creature_recall[monster.creature_id].defenses |= creature_defense;
@@ -2067,11 +2086,12 @@ bool spellDispelCreature(int creature_defense, int damage) {
 bool spellTurnUndead() {
     bool turned = false;
 
-    for (int id = next_free_monster_id - 1; id >= config::monsters::MON_MIN_INDEX_ID; id--) {
+    for (int position = monster_pool.used - 1; position >= 0; position--) {
+        int id = monster_pool.ids[position];
         Monster_t &monster = monsters[id];
         Creature_t const &creature = creatures_list[monster.creature_id];
 
-        if (monster.distance_from_player <= config::monsters::MON_MAX_SIGHT && ((creature.defenses & config::monsters::defense::CD_UNDEAD) != 0) && los(py.pos, monster.pos)) {
+        if (monster.distance_from_player <= config::monsters::MON_MAX_SIGHT && ((creature.defenses & config::monsters::defense::CD_UNDEAD) != 0) && losFromPlayer(monster.pos)) {
             auto name = monsterNameDescription(creature.name, monster.lit);
 
             if (py.misc.level + 1 > creature.level || randomNumber(5) == 1) {
@@ -2097,7 +2117,7 @@ bool spellTurnUndead() {
 void spellWardingGlyph() {
     if (dg.floor[py.pos.y][py.pos.x].treasure_id == 0) {
         int free_id = popt();
-        dg.floor[py.pos.y][py.pos.x].treasure_id = (uint8_t) free_id;
+        dungeonSetTreasureId(py.pos, free_id);
         inventoryItemCopyTo(config::dungeon::objects::OBJ_SCARE_MON, game.treasure.list[free_id]);
     }
 }
@@ -2213,7 +2233,7 @@ bool spellSlowPoison() {
 }
 
 static void replaceSpot(Coord_t coord, int typ) {
-    Tile_t &tile = dg.floor[coord.y][coord.x];
+    Tile_t tile = dg.floor[coord.y][coord.x];
 
     switch (typ) {
         case 1:
@@ -2243,6 +2263,8 @@ static void replaceSpot(Coord_t coord, int typ) {
     tile.permanent_light = false;
     tile.field_mark = false;
     tile.perma_lit_room = false; // this is no longer part of a room
+    losMapChanged();
+    openFloorUpdate(coord);
 
     if (tile.treasure_id != 0) {
         (void) dungeonDeleteObject(coord);
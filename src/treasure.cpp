@@ -820,7 +820,7 @@ static void cursedProjectileAdjustment(Inventory_t &item, int level) {
 
 // Counter for missiles
 // Note: converted to uint16_t when saving the game.
-int16_t missiles_counter = 0;
+thread_local int16_t missiles_counter = 0;
 
 static void magicalProjectile(Inventory_t &item, int special, int level, int chance, int cursed) {
     if (item.category_id == TV_SLING_AMMO || item.category_id == TV_BOLT || item.category_id == TV_ARROW) {
@@ -834,11 +834,8 @@ static void magicalProjectile(Inventory_t &item, int special, int level, int cha
         }
     }
 
-    item.items_count = 0;
-
-    for (int i = 0; i < 7; i++) {
-        item.items_count += randomNumber(6);
-    }
+    // 7d6
+    item.items_count = (uint8_t) diceRoll(Dice_t{7, 6});
 
     if (missiles_counter == SHRT_MAX) {
         missiles_counter = -SHRT_MAX - 1;
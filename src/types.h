@@ -23,3 +23,20 @@ typedef struct {
     int y;
     int x;
 } Coord_t;
+
+// IdPool_t hands out the ids from `first` to `capacity - 1` for the monster
+// and treasure lists, reusing released ids, so an id stays the same for as
+// long as it is in use. The ids in use are `ids[0]` to `ids[used - 1]`, in the
+// order they were allocated, except that releasing an id moves the last one
+// into its place. The free ids follow them. `positions` holds the index of
+// each id in `ids`. Ids are stored in a byte on each dungeon tile.
+// A pool can also be used as a set of ids, see idPoolTake().
+constexpr int ID_POOL_MAX_IDS = 256;
+
+typedef struct {
+    int16_t first;
+    int16_t capacity;
+    int16_t used;
+    uint8_t ids[ID_POOL_MAX_IDS];
+    uint8_t positions[ID_POOL_MAX_IDS];
+} IdPool_t;
@@ -12,11 +12,11 @@ static const char *stat_names[] = {
 static char blank_string[] = "                        ";
 
 // Track screen changes for inventory commands
-bool screen_has_changed = false;
+thread_local bool screen_has_changed = false;
 
-bool message_ready_to_print;            // Set with first message
-vtype_t messages[MESSAGE_HISTORY_SIZE]; // Saved message history -CJS-
-int16_t last_message_id = 0;            // Index of last message held in saved messages array
+thread_local bool message_ready_to_print;            // Set with first message
+thread_local vtype_t messages[MESSAGE_HISTORY_SIZE]; // Saved message history -CJS-
+thread_local int16_t last_message_id = 0;            // Index of last message held in saved messages array
 
 // Calculates current boundaries -RAK-
 static void panelBounds() {
@@ -80,22 +80,21 @@ bool coordInsidePanel(Coord_t coord) {
 
 // Prints the map of the dungeon -RAK-
 void drawDungeonPanel() {
-    int line = 1;
+    // One row of the panel, and the blank column right of it
+    char row[SCREEN_WIDTH + 1];
+    row[SCREEN_WIDTH] = ' ';
 
     Coord_t coord = Coord_t{0, 0};
 
-    // Top to bottom
+    // Top to bottom. Whole rows are handed over rather than erasing the line
+    // first, so only the tiles which changed reach the screen.
     for (coord.y = dg.panel.top; coord.y <= dg.panel.bottom; coord.y++) {
-        eraseLine(Coord_t{line, 13});
-        line++;
-
         // Left to right
         for (coord.x = dg.panel.left; coord.x <= dg.panel.right; coord.x++) {
-            char ch = caveGetTileSymbol(coord);
-            if (ch != ' ') {
-                panelPutTile(ch, coord);
-            }
+            row[coord.x - dg.panel.left] = caveGetTileSymbol(coord);
         }
+
+        panelPutTiles(row, SCREEN_WIDTH + 1, Coord_t{coord.y, dg.panel.left});
     }
 }
 
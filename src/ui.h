@@ -42,13 +42,53 @@ constexpr char DELETE = 0x7f;
 #undef ESCAPE
 constexpr char ESCAPE = '\033'; // ESCAPE character -CJS-
 
-extern bool screen_has_changed;
-extern bool message_ready_to_print;
-extern vtype_t messages[MESSAGE_HISTORY_SIZE];
-extern int16_t last_message_id;
-
-extern int eof_flag;
-extern bool panic_save;
+extern thread_local bool screen_has_changed;
+extern thread_local bool message_ready_to_print;
+extern thread_local vtype_t messages[MESSAGE_HISTORY_SIZE];
+extern thread_local int16_t last_message_id;
+
+extern thread_local int eof_flag;
+extern thread_local bool panic_save;
+
+// UI - Renderer
+// Screen output goes through one of these backends, selected before terminalInitialize().
+enum class Renderer {
+    Curses,      // the real terminal
+    Framebuffer, // an in-memory 24x80 screen, for headless games
+};
+
+void rendererSelect(Renderer renderer);
+bool rendererIsHeadless();
+const char *rendererScreenRow(int row);
+bool rendererInitialize();
+void rendererRestore();
+void rendererRefresh();
+void rendererRedraw();
+void rendererClear();
+void rendererClearToEndOfLine();
+void rendererClearToBottom();
+bool rendererMoveCursor(Coord_t coord);
+bool rendererAddChar(char ch);
+bool rendererAddString(const char *str);
+bool rendererPutChars(Coord_t coord, const char *chars, int count);
+Coord_t rendererCursorPosition();
+void rendererSaveScreen();
+void rendererRestoreScreen();
+int rendererReadKey();
+int rendererReadKeyNonBlocking();
+
+// UI - Input
+// Keys come from the terminal unless a key script is selected before the game starts.
+bool inputSelectFile(const char *filename);
+void inputSelectQueue(void (*refill)());
+void inputQueueKeys(const std::string &keys);
+void inputSelectReplay(int (*readKey)(), bool (*keyPending)());
+void inputRecord(void (*keyRead)(int key, bool end_of_script), void (*keyChecked)(bool pending, bool end_of_input));
+bool inputIsScripted();
+bool inputScriptEnded();
+int inputReadKey();
+bool inputKeyPending(int microseconds);
+void inputEndOfScript();
 
 // UI - IO
 bool terminalInitialize();
@@ -67,6 +107,7 @@ void putStringClearToEOL(const std::string &str, Coord_t coord);
 void eraseLine(Coord_t coord);
 void panelMoveCursor(Coord_t coord);
 void panelPutTile(char ch, Coord_t coord);
+void panelPutTiles(const char *chars, int count, Coord_t coord);
 void messageLinePrintMessage(std::string message);
 void messageLineClear();
 void printMessage(const char *msg);
@@ -0,0 +1,291 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Keyboard input sources: the terminal, a key script file/pipe, an in-process queue, or a replay
+
+#include "headers.h"
+
+// InputSource_t holds the functions used to read keys from an input source.
+// `readKey` blocks until a key is available, returning EOF when there are no more keys.
+// `keyPending` checks (and consumes) a key pressed during a rest/run/repeat.
+typedef struct {
+    int (*readKey)();
+    bool (*keyPending)(int microseconds);
+} InputSource_t;
+
+//
+// Terminal input, with keys read by the renderer
+//
+
+static int terminalReadKey() {
+    return rendererReadKey();
+}
+
+// Provides for a timeout on input. Does a non-blocking read, consuming the data if
+// any, and then returns 1 if data was read, zero otherwise.
+//
+// Porting:
+//
+// In systems without the select call, but with a sleep for fractional numbers of
+// seconds, one could sleep for the time and then check for input.
+//
+// In systems which can only sleep for whole number of seconds, you might sleep by
+// writing a lot of nulls to the terminal, and waiting for them to drain, or you
+// might hack a static accumulation of times to wait. When the accumulation reaches
+// a certain point, sleep for a second. There would need to be a way of resetting
+// the count, with a call made for commands like run or rest.
+static bool terminalKeyPending(int microseconds) {
+#ifdef _WIN32
+    (void) microseconds;
+
+    return rendererReadKeyNonBlocking() > 0;
+#else
+    struct timeval tbuf {};
+    int ch;
+    int smask;
+
+    // Return true if a read on descriptor 1 will not block.
+    tbuf.tv_sec = 0;
+    tbuf.tv_usec = microseconds;
+
+    smask = 1; // i.e. (1 << 0)
+    if (select(1, (fd_set *) &smask, (fd_set *) nullptr, (fd_set *) nullptr, &tbuf) == 1) {
+        ch = rendererReadKey();
+        // check for EOF errors here, select sometimes works even when EOF
+        if (ch == -1) {
+            eof_flag++;
+            return false;
+        }
+        return true;
+    }
+
+    return false;
+#endif
+}
+
+static const InputSource_t terminal_source = {
+    terminalReadKey,
+    terminalKeyPending,
+};
+
+//
+// Scripted input
+//
+// Scripts are read in order, one key after another, and never interrupt
+// a rest/run/repeat, so the same script always plays the same game.
+// There are no timeouts, and running out of keys ends the game.
+//
+
+// Scripts never have a key waiting, so a game plays out the same every time.
+static bool scriptKeyPending(int microseconds) {
+    (void) microseconds;
+    return false;
+}
+
+// Key script read from a file or pipe, with `-` meaning standard input.
+typedef struct {
+    int fd;
+    char buffer[4096];
+    ssize_t length;
+    ssize_t position;
+} ScriptFile_t;
+
+static thread_local ScriptFile_t script_file = {-1, {}, 0, 0};
+
+static int scriptFileReadKey() {
+    if (script_file.position >= script_file.length) {
+        script_file.length = read(script_file.fd, script_file.buffer, sizeof(script_file.buffer));
+        script_file.position = 0;
+
+        if (script_file.length <= 0) {
+            script_file.length = 0;
+            return EOF;
+        }
+    }
+
+    return (unsigned char) script_file.buffer[script_file.position++];
+}
+
+static const InputSource_t script_file_source = {
+    scriptFileReadKey,
+    scriptKeyPending,
+};
+
+// Key queue filled in-process. When empty, the optional refill function is
+// called to queue more keys, e.g. by an automated player.
+typedef struct {
+    std::string keys;
+    size_t position;
+    void (*refill)();
+} ScriptQueue_t;
+
+static thread_local ScriptQueue_t script_queue = {"", 0, nullptr};
+
+static int scriptQueueReadKey() {
+    if (script_queue.position >= script_queue.keys.size()) {
+        script_queue.keys.clear();
+        script_queue.position = 0;
+
+        // The refill may itself read keys, e.g. to dismiss a -more- prompt,
+        // so check the position again rather than only for an empty queue.
+        if (script_queue.refill != nullptr) {
+            script_queue.refill();
+        }
+        if (script_queue.position >= script_queue.keys.size()) {
+            return EOF;
+        }
+    }
+
+    return (unsigned char) script_queue.keys[script_queue.position++];
+}
+
+static const InputSource_t script_queue_source = {
+    scriptQueueReadKey,
+    scriptKeyPending,
+};
+
+//
+// Replayed input
+//
+// Keys and key checks are played back from a recording, see game_replay.cpp.
+// Unlike a script, the end of input is played back as it happened: the
+// recording hands out EOF, and ends the game itself once it runs out.
+//
+
+typedef struct {
+    int (*readKey)();
+    bool (*keyPending)();
+} InputReplay_t;
+
+static thread_local InputReplay_t input_replay = {nullptr, nullptr};
+
+static int replayReadKey() {
+    return input_replay.readKey();
+}
+
+static bool replayKeyPending(int microseconds) {
+    (void) microseconds;
+    return input_replay.keyPending();
+}
+
+static const InputSource_t replay_source = {
+    replayReadKey,
+    replayKeyPending,
+};
+
+// Optional recorder, told of every key read and every key check.
+typedef struct {
+    void (*keyRead)(int key, bool end_of_script);
+    void (*keyChecked)(bool pending, bool end_of_input);
+} InputRecorder_t;
+
+static thread_local InputRecorder_t input_recorder = {nullptr, nullptr};
+
+//
+// The input source used by this game
+//
+
+static thread_local const InputSource_t *source = &terminal_source;
+static thread_local bool script_ended = false;
+
+// Read keys from a script file, or standard input when `filename` is "-"
+bool inputSelectFile(const char *filename) {
+    int fd = 0;
+
+    if (strcmp(filename, "-") != 0) {
+        fd = open(filename, O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+    }
+
+    if (script_file.fd > 0) {
+        (void) close(script_file.fd);
+    }
+
+    script_file.fd = fd;
+    script_file.length = 0;
+    script_file.position = 0;
+
+    source = &script_file_source;
+    script_ended = false;
+
+    return true;
+}
+
+// Read keys from the in-process queue, see inputQueueKeys()
+void inputSelectQueue(void (*refill)()) {
+    script_queue.keys.clear();
+    script_queue.position = 0;
+    script_queue.refill = refill;
+
+    source = &script_queue_source;
+    script_ended = false;
+}
+
+void inputQueueKeys(const std::string &keys) {
+    script_queue.keys += keys;
+}
+
+// Play back a recording: `readKey` returns the next recorded key, and
+// `keyPending` the outcome of the next key check.
+void inputSelectReplay(int (*readKey)(), bool (*keyPending)()) {
+    input_replay.readKey = readKey;
+    input_replay.keyPending = keyPending;
+
+    source = &replay_source;
+    script_ended = false;
+}
+
+// Report every key read and key check to the recorder, or stop when nullptr.
+// An EOF from a script is reported as the end of the script, which stops the game.
+void inputRecord(void (*keyRead)(int key, bool end_of_script), void (*keyChecked)(bool pending, bool end_of_input)) {
+    input_recorder.keyRead = keyRead;
+    input_recorder.keyChecked = keyChecked;
+}
+
+bool inputIsScripted() {
+    return source == &script_file_source || source == &script_queue_source;
+}
+
+// True once a game was stopped by its script running out of keys.
+bool inputScriptEnded() {
+    return script_ended;
+}
+
+int inputReadKey() {
+    int key = source->readKey();
+
+    if (input_recorder.keyRead != nullptr) {
+        input_recorder.keyRead(key, key == EOF && inputIsScripted());
+    }
+
+    return key;
+}
+
+bool inputKeyPending(int microseconds) {
+    int eof_before = eof_flag;
+    bool pending = source->keyPending(microseconds);
+
+    if (input_recorder.keyChecked != nullptr) {
+        input_recorder.keyChecked(pending, eof_flag != eof_before);
+    }
+
+    return pending;
+}
+
+// The script has run out of keys: stop the game right away, without saving.
+void inputEndOfScript() {
+    script_ended = true;
+
+    // avoid any -more- prompts while shutting down.
+    message_ready_to_print = false;
+
+    if (!game.character_is_dead) {
+        (void) strcpy(game.character_died_from, "(end of script)");
+    }
+
+    exitProgram();
+}
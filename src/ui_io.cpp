@@ -3,108 +3,66 @@
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
-// Terminal I/O code, uses the curses package
+// Terminal I/O code, drawing is done by the selected renderer
 
 #include <cstdlib>
 #include "headers.h"
-#include "curses.h"
 
-static bool curses_on = false;
+thread_local int eof_flag = 0;        // Is used to signal EOF/HANGUP condition
+thread_local bool panic_save = false; // True if playing from a panic save
 
-// Spare window for saving the screen. -CJS-
-static WINDOW *save_screen;
-
-int eof_flag = 0;        // Is used to signal EOF/HANGUP condition
-bool panic_save = false; // True if playing from a panic save
-
-// Set up the terminal into a suitable state -MRC-
-static void moriaTerminalInitialize() {
-    // cbreak();           // <curses.h> use raw() instead as it disables Ctrl chars
-    raw();                 // <curses.h> disable control characters. I.e. Ctrl-C does not work!
-    noecho();              // <curses.h> do not echo typed characters
-    nonl();                // <curses.h> disable translation return/newline for detection of return key
-    keypad(stdscr, false); // <curses.h> disable keypad input as we handle that ourselves
-    // curs_set(0);        // <curses.h> sets the appearance of the cursor based on the value of visibility
-
-#ifdef __APPLE__
-    set_escdelay(50); // <curses.h> default delay on macOS is 1 second, let's do something about that!
-#endif
-
-    curses_on = true;
-}
+static void flushScreen();
 
 // initializes the terminal / curses routines
 bool terminalInitialize() {
-    initscr();
-
-    // Check we have enough screen. -CJS-
-    if (LINES < 24 || COLS < 80) {
-        (void) printf("Screen too small for moria.\n");
-        return false;
-    }
-
-    save_screen = newwin(0, 0, 0, 0);
-    if (save_screen == nullptr) {
-        (void) printf("Out of memory in starting up curses.\n");
-        return false;
-    }
-
-    moriaTerminalInitialize();
-
-    (void) clear();
-    (void) refresh();
-
-    return true;
+    return rendererInitialize();
 }
 
 // Put the terminal in the original mode. -CJS-
 void terminalRestore() {
-    if (!curses_on) {
-        return;
-    }
-
     // Dump any remaining buffer
-    putQIO();
+    flushScreen();
 
-    // this moves curses to bottom right corner
-    int y = 0;
-    int x = 0;
-    getyx(stdscr, y, x);
-    mvcur(y, x, LINES - 1, 0);
-
-    // exit curses
-    endwin();
-    (void) fflush(stdout);
-
-    curses_on = false;
+    rendererRestore();
 }
 
 void terminalSaveScreen() {
-    overwrite(stdscr, save_screen);
+    rendererSaveScreen();
 }
 
 void terminalRestoreScreen() {
-    overwrite(save_screen, stdscr);
-    touchwin(stdscr);
+    rendererRestoreScreen();
 }
 
 ssize_t terminalBellSound() {
     putQIO();
 
     // The player can turn off beeps if they find them annoying.
-    if (config::options::error_beep_sound) {
+    if (config::options::error_beep_sound && !rendererIsHeadless()) {
         return write(1, "\007", 1);
     }
 
     return 0;
 }
 
-// Dump the IO buffer to terminal -RAK-
-void putQIO() {
+// Dump the IO buffer to terminal, even when fast-forwarding.
+static void flushScreen() {
     // Let inventoryExecuteCommand() know something has changed.
     screen_has_changed = true;
 
-    (void) refresh();
+    rendererRefresh();
+}
+
+// Dump the IO buffer to terminal -RAK-
+void putQIO() {
+    // When fast-forwarding, the screen is only updated once the
+    // rest/repeat/run stops and we are waiting on the player again.
+    if (config::options::fast_forward && playerIsBusy()) {
+        screen_has_changed = true;
+        return;
+    }
+
+    flushScreen();
 }
 
 // Flush the buffer -RAK-
@@ -122,21 +80,21 @@ void clearScreen() {
     if (message_ready_to_print) {
         printMessage(CNIL);
     }
-    (void) clear();
+    rendererClear();
 }
 
 void clearToBottom(int row) {
-    (void) move(row, 0);
-    clrtobot();
+    (void) rendererMoveCursor(Coord_t{row, 0});
+    rendererClearToBottom();
 }
 
 // move cursor to a given y, x position
 void moveCursor(Coord_t coord) {
-    (void) move(coord.y, coord.x);
+    (void) rendererMoveCursor(coord);
 }
 
 void addChar(char ch, Coord_t coord) {
-    if (mvaddch(coord.y, coord.x, ch) == ERR) {
+    if (!rendererMoveCursor(coord) || !rendererAddChar(ch)) {
         abort();
     }
 }
@@ -152,7 +110,7 @@ void putString(const char *out_str, Coord_t coord) {
     (void) strncpy(str, out_str, (size_t) (79 - coord.x));
     str[79 - coord.x] = '\0';
 
-    if (mvaddstr(coord.y, coord.x, str) == ERR) {
+    if (!rendererMoveCursor(coord) || !rendererAddString(str)) {
         abort();
     }
 }
@@ -163,8 +121,8 @@ void putStringClearToEOL(const std::string &str, Coord_t coord) {
         printMessage(CNIL);
     }
 
-    (void) move(coord.y, coord.x);
-    clrtoeol();
+    (void) rendererMoveCursor(coord);
+    rendererClearToEndOfLine();
     putString(str.c_str(), coord);
 }
 
@@ -174,8 +132,8 @@ void eraseLine(Coord_t coord) {
         printMessage(CNIL);
     }
 
-    (void) move(coord.y, coord.x);
-    clrtoeol();
+    (void) rendererMoveCursor(coord);
+    rendererClearToEndOfLine();
 }
 
 // Moves the cursor to a given interpolated y, x position -RAK-
@@ -184,60 +142,61 @@ void panelMoveCursor(Coord_t coord) {
     coord.y -= dg.panel.row_prt;
     coord.x -= dg.panel.col_prt;
 
-    if (move(coord.y, coord.x) == ERR) {
+    if (!rendererMoveCursor(coord)) {
         abort();
     }
 }
 
 // Outputs a char to a given interpolated y, x position -RAK-
 // sign bit of a character used to indicate standout mode. -CJS
+// Tiles already showing `ch` are left alone.
 void panelPutTile(char ch, Coord_t coord) {
+    panelPutTiles(&ch, 1, coord);
+}
+
+// Outputs `count` chars along the row from a given interpolated y, x position,
+// leaving alone the tiles which already show them.
+void panelPutTiles(const char *chars, int count, Coord_t coord) {
     // Real coords convert to screen positions
     coord.y -= dg.panel.row_prt;
     coord.x -= dg.panel.col_prt;
 
-    if (mvaddch(coord.y, coord.x, ch) == ERR) {
+    if (!rendererPutChars(coord, chars, count)) {
         abort();
     }
 }
 
-static Coord_t currentCursorPosition() {
-    int y, x;
-    getyx(stdscr, y, x);
-    return Coord_t{y, x};
-}
-
 // messageLinePrintMessage will print a line of text to the message line (0,0).
 // first clearing the line of any text!
 void messageLinePrintMessage(std::string message) {
     // save current cursor position
-    Coord_t coord = currentCursorPosition();
+    Coord_t coord = rendererCursorPosition();
 
     // move to beginning of message line, and clear it
-    move(0, 0);
-    clrtoeol();
+    (void) rendererMoveCursor(Coord_t{0, 0});
+    rendererClearToEndOfLine();
 
     // truncate message if it's too long!
     message.resize(79);
 
-    addstr(message.c_str());
+    (void) rendererAddString(message.c_str());
 
     // restore cursor to old position
-    move(coord.y, coord.x);
+    (void) rendererMoveCursor(coord);
 }
 
 // deleteMessageLine will delete all text from the message line (0,0).
 // The current cursor position will be maintained.
 void messageLineClear() {
     // save current cursor position
-    Coord_t coord = currentCursorPosition();
+    Coord_t coord = rendererCursorPosition();
 
     // move to beginning of message line, and clear it
-    move(0, 0);
-    clrtoeol();
+    (void) rendererMoveCursor(Coord_t{0, 0});
+    rendererClearToEndOfLine();
 
     // restore cursor to old position
-    move(coord.y, coord.x);
+    (void) rendererMoveCursor(coord);
 }
 
 // Outputs message to top line of screen
@@ -278,8 +237,8 @@ void printMessage(const char *msg) {
     }
 
     if (!combine_messages) {
-        (void) move(MSG_LINE, 0);
-        clrtoeol();
+        (void) rendererMoveCursor(Coord_t{MSG_LINE, 0});
+        rendererClearToEndOfLine();
     }
 
     // Make the null string a special case. -CJS-
@@ -329,11 +288,15 @@ void printMessageNoCommandInterrupt(const std::string &msg) {
 // terminal, so that this operation can always be performed at
 // any input prompt. getKeyInput() never returns ^R.
 char getKeyInput() {
-    putQIO();               // Dump IO buffer
+    flushScreen();          // Dump IO buffer
     game.command_count = 0; // Just to be safe -CJS-
 
     while (true) {
-        int ch = getch();
+        int ch = inputReadKey();
+
+        if (ch == EOF && inputIsScripted()) {
+            inputEndOfScript();
+        }
 
         // some machines may not sign extend.
         if (ch == EOF) {
@@ -342,7 +305,7 @@ char getKeyInput() {
 
             eof_flag++;
 
-            (void) refresh();
+            rendererRefresh();
 
             if (!game.character_generated || game.character_saved) {
                 endGame();
@@ -368,8 +331,7 @@ char getKeyInput() {
             return (char) ch;
         }
 
-        (void) wrefresh(curscr);
-        moriaTerminalInitialize();
+        rendererRedraw();
     }
 }
 
@@ -398,13 +360,13 @@ bool getMenuItemId(const std::string &prompt, char &command) {
 // Gets a string terminated by <RETURN>
 // Function returns false if <ESCAPE> is input
 bool getStringInput(char *in_str, Coord_t coord, int slen) {
-    (void) move(coord.y, coord.x);
+    (void) rendererMoveCursor(coord);
 
     for (int i = slen; i > 0; i--) {
-        (void) addch(' ');
+        (void) rendererAddChar(' ');
     }
 
-    (void) move(coord.y, coord.x);
+    (void) rendererMoveCursor(coord);
 
     int start_col = coord.x;
     int end_col = coord.x + slen - 1;
@@ -441,7 +403,8 @@ bool getStringInput(char *in_str, Coord_t coord, int slen) {
                 if ((isprint(key) == 0) || coord.x > end_col) {
                     terminalBellSound();
                 } else {
-                    mvaddch(coord.y, coord.x, (char) key);
+                    (void) rendererMoveCursor(coord);
+                    (void) rendererAddChar((char) key);
                     *p++ = (char) key;
                     coord.x++;
                 }
@@ -473,16 +436,11 @@ bool getInputConfirmation(const std::string &prompt) {
 int getInputConfirmationWithAbort(int column, const std::string &prompt) {
     putStringClearToEOL(prompt, Coord_t{0, column});
 
-    int y, x;
-    getyx(stdscr, y, x);
-
-    if (x > 73) {
-        (void) move(0, 73);
-    } else if (y != 0) {
-        // use `y` to prevent compiler warning.
+    if (rendererCursorPosition().x > 73) {
+        (void) rendererMoveCursor(Coord_t{0, 73});
     }
 
-    (void) addstr(" [y/n]");
+    (void) rendererAddString(" [y/n]");
 
     char key = ' ';
     while (key == ' ') {
@@ -507,51 +465,10 @@ void waitForContinueKey(int line_number) {
     eraseLine(Coord_t{line_number, 0});
 }
 
-// Provides for a timeout on input. Does a non-blocking read, consuming the data if
-// any, and then returns 1 if data was read, zero otherwise.
-//
-// Porting:
-//
-// In systems without the select call, but with a sleep for fractional numbers of
-// seconds, one could sleep for the time and then check for input.
-//
-// In systems which can only sleep for whole number of seconds, you might sleep by
-// writing a lot of nulls to the terminal, and waiting for them to drain, or you
-// might hack a static accumulation of times to wait. When the accumulation reaches
-// a certain point, sleep for a second. There would need to be a way of resetting
-// the count, with a call made for commands like run or rest.
+// Returns true if a key was pressed within the given time, consuming the key.
+// Scripted input never has a key pending, and never waits.
 bool checkForNonBlockingKeyPress(int microseconds) {
-#ifdef _WIN32
-    (void) microseconds;
-
-    // Ugly non-blocking read...Ugh! -MRC-
-    timeout(8);
-    int result = getch();
-    timeout(-1);
-
-    return result > 0;
-#else
-    struct timeval tbuf {};
-    int ch;
-    int smask;
-
-    // Return true if a read on descriptor 1 will not block.
-    tbuf.tv_sec = 0;
-    tbuf.tv_usec = microseconds;
-
-    smask = 1; // i.e. (1 << 0)
-    if (select(1, (fd_set *) &smask, (fd_set *) nullptr, (fd_set *) nullptr, &tbuf) == 1) {
-        ch = getch();
-        // check for EOF errors here, select sometimes works even when EOF
-        if (ch == -1) {
-            eof_flag++;
-            return false;
-        }
-        return true;
-    }
-
-    return false;
-#endif
+    return inputKeyPending(microseconds);
 }
 
 // Find a default user name from the system.
@@ -0,0 +1,559 @@
+// Copyright (c) 1981-86 Robert A. Koeneke
+// Copyright (c) 1987-94 James E. Wilson
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Screen output backends: the curses terminal, or an in-memory framebuffer
+
+#include "headers.h"
+#include "curses.h"
+
+// RendererBackend_t holds the screen primitives used by the UI IO functions.
+// All drawing happens at the cursor position, just like curses.
+// Keys are read with the backend too, returning EOF at end of input.
+typedef struct {
+    bool (*initialize)();
+    void (*restore)();
+    void (*refresh)();
+    void (*redraw)();
+    void (*clear)();
+    void (*clearToEndOfLine)();
+    void (*clearToBottom)();
+    bool (*moveCursor)(Coord_t coord);
+    bool (*addChar)(char ch);
+    bool (*addString)(const char *str);
+    Coord_t (*cursorPosition)();
+    void (*saveScreen)();
+    void (*restoreScreen)();
+    int (*readKey)();
+    int (*readKeyNonBlocking)();
+} RendererBackend_t;
+
+//
+// Curses backend
+//
+
+static bool curses_on = false;
+
+// Spare window for saving the screen. -CJS-
+static WINDOW *save_screen;
+
+// Set up the terminal into a suitable state -MRC-
+static void moriaTerminalInitialize() {
+    // cbreak();           // <curses.h> use raw() instead as it disables Ctrl chars
+    raw();                 // <curses.h> disable control characters. I.e. Ctrl-C does not work!
+    noecho();              // <curses.h> do not echo typed characters
+    nonl();                // <curses.h> disable translation return/newline for detection of return key
+    keypad(stdscr, false); // <curses.h> disable keypad input as we handle that ourselves
+    // curs_set(0);        // <curses.h> sets the appearance of the cursor based on the value of visibility
+
+#ifdef __APPLE__
+    set_escdelay(50); // <curses.h> default delay on macOS is 1 second, let's do something about that!
+#endif
+
+    curses_on = true;
+}
+
+static bool cursesInitialize() {
+    initscr();
+
+    // Check we have enough screen. -CJS-
+    if (LINES < 24 || COLS < 80) {
+        (void) printf("Screen too small for moria.\n");
+        return false;
+    }
+
+    save_screen = newwin(0, 0, 0, 0);
+    if (save_screen == nullptr) {
+        (void) printf("Out of memory in starting up curses.\n");
+        return false;
+    }
+
+    moriaTerminalInitialize();
+
+    (void) clear();
+    (void) refresh();
+
+    return true;
+}
+
+static void cursesRestore() {
+    if (!curses_on) {
+        return;
+    }
+
+    // Dump any remaining buffer
+    (void) refresh();
+
+    // this moves curses to bottom right corner
+    int y = 0;
+    int x = 0;
+    getyx(stdscr, y, x);
+    mvcur(y, x, LINES - 1, 0);
+
+    // exit curses
+    endwin();
+    (void) fflush(stdout);
+
+    curses_on = false;
+}
+
+static void cursesRefresh() {
+    (void) refresh();
+}
+
+static void cursesRedraw() {
+    (void) wrefresh(curscr);
+    moriaTerminalInitialize();
+}
+
+static void cursesClear() {
+    (void) clear();
+}
+
+static void cursesClearToEndOfLine() {
+    (void) clrtoeol();
+}
+
+static void cursesClearToBottom() {
+    (void) clrtobot();
+}
+
+static bool cursesMoveCursor(Coord_t coord) {
+    return move(coord.y, coord.x) != ERR;
+}
+
+static bool cursesAddChar(char ch) {
+    return addch(ch) != ERR;
+}
+
+static bool cursesAddString(const char *str) {
+    return addstr(str) != ERR;
+}
+
+static Coord_t cursesCursorPosition() {
+    int y, x;
+    getyx(stdscr, y, x);
+    return Coord_t{y, x};
+}
+
+static void cursesSaveScreen() {
+    overwrite(stdscr, save_screen);
+}
+
+static void cursesRestoreScreen() {
+    overwrite(save_screen, stdscr);
+    touchwin(stdscr);
+}
+
+static int cursesReadKey() {
+    return getch();
+}
+
+// Ugly non-blocking read...Ugh! -MRC-
+static int cursesReadKeyNonBlocking() {
+    timeout(8);
+    int ch = getch();
+    timeout(-1);
+
+    return ch;
+}
+
+static const RendererBackend_t curses_backend = {
+    cursesInitialize,
+    cursesRestore,
+    cursesRefresh,
+    cursesRedraw,
+    cursesClear,
+    cursesClearToEndOfLine,
+    cursesClearToBottom,
+    cursesMoveCursor,
+    cursesAddChar,
+    cursesAddString,
+    cursesCursorPosition,
+    cursesSaveScreen,
+    cursesRestoreScreen,
+    cursesReadKey,
+    cursesReadKeyNonBlocking,
+};
+
+//
+// Framebuffer backend
+//
+// Keeps the screen in memory only, so headless games skip any terminal
+// emulation, while tests can still inspect what would have been shown.
+//
+
+constexpr uint8_t FRAMEBUFFER_ROWS = 24;
+constexpr uint8_t FRAMEBUFFER_COLUMNS = 80;
+
+typedef struct {
+    // One extra column for the '\0' so rows can be read as strings.
+    char rows[FRAMEBUFFER_ROWS][FRAMEBUFFER_COLUMNS + 1];
+    Coord_t cursor;
+} Framebuffer_t;
+
+static thread_local Framebuffer_t framebuffer;
+static thread_local Framebuffer_t framebuffer_saved;
+
+static void framebufferClearFrom(int row, int column) {
+    for (int x = column; x < FRAMEBUFFER_COLUMNS; x++) {
+        framebuffer.rows[row][x] = ' ';
+    }
+    framebuffer.rows[row][FRAMEBUFFER_COLUMNS] = '\0';
+}
+
+static void framebufferClear() {
+    for (int y = 0; y < FRAMEBUFFER_ROWS; y++) {
+        framebufferClearFrom(y, 0);
+    }
+    framebuffer.cursor = Coord_t{0, 0};
+}
+
+static bool framebufferInitialize() {
+    framebufferClear();
+    framebuffer_saved = framebuffer;
+    return true;
+}
+
+static void framebufferNothing() {
+    // Nothing to flush, restore or redraw.
+}
+
+static void framebufferClearToEndOfLine() {
+    framebufferClearFrom(framebuffer.cursor.y, framebuffer.cursor.x);
+}
+
+static void framebufferClearToBottom() {
+    framebufferClearToEndOfLine();
+    for (int y = framebuffer.cursor.y + 1; y < FRAMEBUFFER_ROWS; y++) {
+        framebufferClearFrom(y, 0);
+    }
+}
+
+static bool framebufferMoveCursor(Coord_t coord) {
+    if (coord.y < 0 || coord.y >= FRAMEBUFFER_ROWS || coord.x < 0 || coord.x >= FRAMEBUFFER_COLUMNS) {
+        return false;
+    }
+    framebuffer.cursor = coord;
+    return true;
+}
+
+// Mimics curses addch(): newlines clear the rest of the line,
+// and the cursor wraps at the right edge of the screen.
+static bool framebufferAddChar(char ch) {
+    Coord_t &cursor = framebuffer.cursor;
+
+    if (ch == '\n') {
+        framebufferClearToEndOfLine();
+        cursor.x = FRAMEBUFFER_COLUMNS;
+    } else if (ch == '\t') {
+        do {
+            framebuffer.rows[cursor.y][cursor.x++] = ' ';
+        } while (cursor.x < FRAMEBUFFER_COLUMNS && (cursor.x & 7) != 0);
+    } else {
+        framebuffer.rows[cursor.y][cursor.x++] = ch;
+    }
+
+    if (cursor.x >= FRAMEBUFFER_COLUMNS) {
+        if (cursor.y == FRAMEBUFFER_ROWS - 1) {
+            cursor.x = FRAMEBUFFER_COLUMNS - 1;
+            return false;
+        }
+        cursor.x = 0;
+        cursor.y++;
+    }
+
+    return true;
+}
+
+static bool framebufferAddString(const char *str) {
+    for (; *str != '\0'; str++) {
+        if (!framebufferAddChar(*str)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Coord_t framebufferCursorPosition() {
+    return framebuffer.cursor;
+}
+
+static void framebufferSaveScreen() {
+    framebuffer_saved = framebuffer;
+}
+
+static void framebufferRestoreScreen() {
+    Coord_t cursor = framebuffer.cursor;
+    framebuffer = framebuffer_saved;
+    framebuffer.cursor = cursor;
+}
+
+// Without a terminal, keys are read straight from standard input.
+static int framebufferReadKey() {
+    unsigned char ch;
+    if (read(0, &ch, 1) != 1) {
+        return EOF;
+    }
+    return ch;
+}
+
+static int framebufferReadKeyNonBlocking() {
+#ifdef _WIN32
+    return framebufferReadKey();
+#else
+    struct timeval tbuf {};
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(0, &fds);
+
+    if (select(1, &fds, nullptr, nullptr, &tbuf) != 1) {
+        return EOF;
+    }
+    return framebufferReadKey();
+#endif
+}
+
+static const RendererBackend_t framebuffer_backend = {
+    framebufferInitialize,
+    framebufferNothing,
+    framebufferNothing,
+    framebufferNothing,
+    framebufferClear,
+    framebufferClearToEndOfLine,
+    framebufferClearToBottom,
+    framebufferMoveCursor,
+    framebufferAddChar,
+    framebufferAddString,
+    framebufferCursorPosition,
+    framebufferSaveScreen,
+    framebufferRestoreScreen,
+    framebufferReadKey,
+    framebufferReadKeyNonBlocking,
+};
+
+//
+// Screen shadow
+//
+// Remembers what every cell of the screen shows, as drawn through the
+// functions below, so rendererPutChars() can skip cells that already show the
+// wanted character and rendererRefresh() can skip flushes with nothing new.
+// Cells which can't be known, like those written past a wrapped line, are
+// held as '\0' until drawn again.
+//
+
+typedef struct {
+    char cells[FRAMEBUFFER_ROWS][FRAMEBUFFER_COLUMNS];
+    bool changed;             // Something was drawn since the last refresh
+    Coord_t refreshed_cursor; // Where the cursor was at the last refresh
+} ScreenShadow_t;
+
+static thread_local ScreenShadow_t screen_shadow;
+static thread_local ScreenShadow_t screen_shadow_saved;
+
+static void screenShadowFill(int row, int column, char ch) {
+    if (row < 0 || row >= FRAMEBUFFER_ROWS || column >= FRAMEBUFFER_COLUMNS) {
+        return;
+    }
+    (void) memset(&screen_shadow.cells[row][column], ch, (size_t) (FRAMEBUFFER_COLUMNS - column));
+}
+
+static void screenShadowFillToBottom(Coord_t from, char ch) {
+    screenShadowFill(from.y, from.x, ch);
+    for (int y = std::max(0, from.y + 1); y < FRAMEBUFFER_ROWS; y++) {
+        screenShadowFill(y, 0, ch);
+    }
+}
+
+// Records the characters written at `cursor`. Anything curses would not
+// put in a single cell, or which runs off the end of the row, leaves the
+// rest of the screen unknown.
+static void screenShadowWrite(Coord_t cursor, const char *str) {
+    screen_shadow.changed = true;
+
+    for (; *str != '\0'; str++) {
+        auto ch = (unsigned char) *str;
+
+        if (ch < ' ' || ch == 127 || cursor.y >= FRAMEBUFFER_ROWS || cursor.x >= FRAMEBUFFER_COLUMNS) {
+            screenShadowFillToBottom(cursor, '\0');
+            return;
+        }
+
+        screen_shadow.cells[cursor.y][cursor.x] = (char) ch;
+        cursor.x++;
+    }
+}
+
+static void screenShadowReset() {
+    screenShadowFillToBottom(Coord_t{0, 0}, ' ');
+    screen_shadow.changed = true;
+    screen_shadow.refreshed_cursor = Coord_t{-1, -1};
+    screen_shadow_saved = screen_shadow;
+}
+
+//
+// The renderer used by this game
+//
+
+static thread_local const RendererBackend_t *backend = &curses_backend;
+
+// Choose the screen backend, must be called before terminalInitialize()
+void rendererSelect(Renderer renderer) {
+    if (renderer == Renderer::Framebuffer) {
+        backend = &framebuffer_backend;
+    } else {
+        backend = &curses_backend;
+    }
+}
+
+bool rendererIsHeadless() {
+    return backend == &framebuffer_backend;
+}
+
+// Returns a row of the framebuffer screen, as a 80 character string.
+const char *rendererScreenRow(int row) {
+    return framebuffer.rows[row];
+}
+
+bool rendererInitialize() {
+    screenShadowReset();
+    return backend->initialize();
+}
+
+void rendererRestore() {
+    backend->restore();
+}
+
+void rendererRefresh() {
+    Coord_t cursor = backend->cursorPosition();
+
+    if (!screen_shadow.changed && cursor.y == screen_shadow.refreshed_cursor.y && cursor.x == screen_shadow.refreshed_cursor.x) {
+        return;
+    }
+
+    backend->refresh();
+
+    screen_shadow.changed = false;
+    screen_shadow.refreshed_cursor = cursor;
+}
+
+void rendererRedraw() {
+    backend->redraw();
+}
+
+void rendererClear() {
+    backend->clear();
+    screenShadowFillToBottom(Coord_t{0, 0}, ' ');
+    screen_shadow.changed = true;
+}
+
+void rendererClearToEndOfLine() {
+    Coord_t cursor = backend->cursorPosition();
+    backend->clearToEndOfLine();
+    screenShadowFill(cursor.y, cursor.x, ' ');
+    screen_shadow.changed = true;
+}
+
+void rendererClearToBottom() {
+    Coord_t cursor = backend->cursorPosition();
+    backend->clearToBottom();
+    screenShadowFillToBottom(cursor, ' ');
+    screen_shadow.changed = true;
+}
+
+bool rendererMoveCursor(Coord_t coord) {
+    return backend->moveCursor(coord);
+}
+
+bool rendererAddChar(char ch) {
+    const char str[2] = {ch, '\0'};
+    screenShadowWrite(backend->cursorPosition(), str);
+    return backend->addChar(ch);
+}
+
+bool rendererAddString(const char *str) {
+    screenShadowWrite(backend->cursorPosition(), str);
+    return backend->addString(str);
+}
+
+// Draws the `count` characters of `chars` along the row from `coord`, leaving
+// alone the cells which already show them. The cursor is only moved when
+// something is drawn.
+bool rendererPutChars(Coord_t coord, const char *chars, int count) {
+    if (coord.y < 0 || coord.y >= FRAMEBUFFER_ROWS || coord.x < 0 || coord.x + count > FRAMEBUFFER_COLUMNS) {
+        profilerCountMany(COUNT_TILES, count);
+
+        if (!rendererMoveCursor(coord)) {
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            if (!rendererAddChar(chars[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char *shown = &screen_shadow.cells[coord.y][coord.x];
+
+    if (memcmp(shown, chars, (size_t) count) == 0) {
+        profilerCountMany(COUNT_TILES_UNCHANGED, count);
+        return true;
+    }
+
+    // Draw each run of changed cells as a string
+    char run[FRAMEBUFFER_COLUMNS + 1];
+    int drawn = 0;
+
+    for (int x = 0; x < count;) {
+        if (shown[x] == chars[x]) {
+            x++;
+            continue;
+        }
+
+        int start = x;
+        while (x < count && shown[x] != chars[x]) {
+            x++;
+        }
+
+        (void) memcpy(run, &chars[start], (size_t) (x - start));
+        run[x - start] = '\0';
+
+        if (!rendererMoveCursor(Coord_t{coord.y, coord.x + start}) || !rendererAddString(run)) {
+            return false;
+        }
+        drawn += x - start;
+    }
+
+    profilerCountMany(COUNT_TILES, drawn);
+    profilerCountMany(COUNT_TILES_UNCHANGED, count - drawn);
+
+    return true;
+}
+
+Coord_t rendererCursorPosition() {
+    return backend->cursorPosition();
+}
+
+void rendererSaveScreen() {
+    backend->saveScreen();
+    screen_shadow_saved = screen_shadow;
+}
+
+void rendererRestoreScreen() {
+    backend->restoreScreen();
+
+    Coord_t refreshed_cursor = screen_shadow.refreshed_cursor;
+    screen_shadow = screen_shadow_saved;
+    screen_shadow.changed = true;
+    screen_shadow.refreshed_cursor = refreshed_cursor;
+}
+
+int rendererReadKey() {
+    return backend->readKey();
+}
+
+int rendererReadKeyNonBlocking() {
+    return backend->readKeyNonBlocking();
+}